@@ -1,3 +1,26 @@
+/* the filter histories, so a restored engine sounds like it never stopped */
+
+struct audio_state_t
+{
+    dc_filter_t dc_filter;
+    int convolution_at = 0;
+    std::vector<double> convolution_buffer;
+    brightness_filter_t brightness_filter;
+    agc_filter_t agc_filter;
+    double wet_ratio = 1.0;
+    double synthesis_ratio = 0.0;
+    double from_value = 0.0;
+    double to_value = 0.0;
+    std::vector<double> wavetable;
+    int last_wavetable_index = 0;
+};
+
+/* raw collector samples normally pass straight through the filters. at reduced detail
+ * they arrive once every few steps and the steps between are interpolated, and at
+ * minimal detail they stop - the processor then replays the last recorded cycle from
+ * a wavetable indexed by crank angle, so pitch still follows the crank. the 8192 tap
+ * convolution only runs at full detail, and crossfades in and out as detail changes */
+
 struct audio_processor_t
 : has_prop_table_t
 {
@@ -14,6 +37,15 @@ struct audio_processor_t
     double upper_gain = 0.6;
     double lower_angular_velocity_r_per_s = 100.0;
     double upper_angular_velocity_r_per_s = 1000.0;
+    int decimation = 1;
+    bool is_convolution_enabled = true; /* by detail level, where use_convolution is by choice */
+    bool is_synthesized = false;
+    double wet_ratio = 1.0;
+    double synthesis_ratio = 0.0;
+    double from_value = 0.0;
+    double to_value = 0.0;
+    std::vector<double> wavetable = std::vector<double>(sim_n::audio_wavetable_size, 0.0);
+    int last_wavetable_index = 0;
 
     audio_processor_t(crankshaft_t& crankshaft)
         : crankshaft{crankshaft}
@@ -36,17 +68,146 @@ struct audio_processor_t
         return prop_table;
     }
 
+    double calc_wavetable_position() const
+    {
+        double position = calc_otto_theta_r(crankshaft.theta_r) / sim_n::four_stroke_r * sim_n::audio_wavetable_size;
+        return std::clamp(position, 0.0, sim_n::audio_wavetable_size - 1.0);
+    }
+
+    /* a fast crank skips bins between samples - they are filled in on a line from the last one */
+
+    void record(double value)
+    {
+        int size = sim_n::audio_wavetable_size;
+        int index = calc_wavetable_position();
+        int skipped = (index - last_wavetable_index + size) % size;
+        if(skipped > 0 and skipped < size / 2)
+        {
+            double last_value = wavetable[last_wavetable_index];
+            for(int step = 1; step < skipped; step++)
+            {
+                wavetable[(last_wavetable_index + step) % size] = last_value + (value - last_value) * step / skipped;
+            }
+        }
+        wavetable[index] = value;
+        last_wavetable_index = index;
+    }
+
+    double calc_wavetable_value() const
+    {
+        double position = calc_wavetable_position();
+        int index = position;
+        double ratio = position - index;
+        double next_value = wavetable[(index + 1) % sim_n::audio_wavetable_size];
+        return wavetable[index] + ratio * (next_value - wavetable[index]);
+    }
+
     void sample(double value)
     {
+        if(synthesis_ratio == 0.0)
+        {
+            record(value); /* held while fading out of the wavetable, which would otherwise fade into itself */
+        }
+        from_value = to_value;
+        to_value = value;
+        if(decimation == 1)
+        {
+            process(value);
+        }
+    }
+
+    /* one of the decimation steps between the last two samples */
+
+    void upsample(int phase)
+    {
+        double ratio = static_cast<double>(phase + 1) / decimation;
+        process(from_value + ratio * (to_value - from_value));
+    }
+
+    void synthesize()
+    {
+        process(calc_wavetable_value());
+    }
+
+    static double step_crossfade(double ratio, bool is_fading_in)
+    {
+        double step = 1.0 / sim_n::audio_crossfade_samples;
+        if(is_fading_in)
+        {
+            return std::min(1.0, ratio + step);
+        }
+        else
+        {
+            return std::max(0.0, ratio - step);
+        }
+    }
+
+    double convolve(double value)
+    {
+        wet_ratio = step_crossfade(wet_ratio, is_convolution_enabled);
+        if(wet_ratio == 1.0)
+        {
+            return convolution_filter->filter(value);
+        }
+        if(wet_ratio == 0.0)
+        {
+            /* history stays current so the convolution can fade back in */
+            convolution_filter->feed(value);
+            return value;
+        }
+        double wet_value = convolution_filter->filter(value);
+        return wet_ratio * wet_value + (1.0 - wet_ratio) * value;
+    }
+
+    void process(double value)
+    {
+        synthesis_ratio = step_crossfade(synthesis_ratio, is_synthesized);
+        if(synthesis_ratio > 0.0)
+        {
+            value = synthesis_ratio * calc_wavetable_value() + (1.0 - synthesis_ratio) * value;
+        }
         agc_filter->gain = interpolate(crankshaft.angular_velocity_r_per_s, lower_angular_velocity_r_per_s, lower_gain, upper_angular_velocity_r_per_s, upper_gain);
         brightness_filter->mix_ratio = interpolate(crankshaft.angular_velocity_r_per_s, lower_angular_velocity_r_per_s, lower_brightness_mix_ratio, upper_angular_velocity_r_per_s, upper_brightness_mix_ratio);
         value = dc_filter->filter(value);
         if(use_convolution)
         {
-            value = convolution_filter->filter(value);
+            value = convolve(value);
         }
         value = brightness_filter->filter(value);
         value = agc_filter->filter(value);
         buffer.push_back(value);
     }
+
+    void capture_state(audio_state_t& state) const
+    {
+        state.dc_filter = *dc_filter;
+        state.convolution_at = convolution_filter->at;
+        state.convolution_buffer.assign(std::begin(convolution_filter->buffer), std::end(convolution_filter->buffer));
+        state.brightness_filter = *brightness_filter;
+        state.agc_filter = *agc_filter;
+        state.wet_ratio = wet_ratio;
+        state.synthesis_ratio = synthesis_ratio;
+        state.from_value = from_value;
+        state.to_value = to_value;
+        state.wavetable = wavetable;
+        state.last_wavetable_index = last_wavetable_index;
+    }
+
+    void restore_state(const audio_state_t& state)
+    {
+        *dc_filter = state.dc_filter;
+        convolution_filter->at = state.convolution_at;
+        std::copy(state.convolution_buffer.begin(), state.convolution_buffer.end(), convolution_filter->buffer);
+        *brightness_filter = state.brightness_filter;
+        *agc_filter = state.agc_filter;
+        wet_ratio = state.wet_ratio;
+        synthesis_ratio = state.synthesis_ratio;
+        from_value = state.from_value;
+        to_value = state.to_value;
+        if(state.wavetable.size() == wavetable.size())
+        {
+            wavetable = state.wavetable;
+            last_wavetable_index = state.last_wavetable_index;
+        }
+    }
 };
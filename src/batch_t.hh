@@ -0,0 +1,151 @@
+/* what the dyno and the ensemble share - a batch of jobs, each run on its own headless engine
+ * and spread across a pool of threads, and a report of one row per job, written in job order
+ * as csv, or as json when the output ends in .json */
+
+struct batch_report_t
+{
+    std::vector<std::string> columns;
+    std::vector<std::vector<std::string>> rows; /* one text per column */
+};
+
+struct batch_t
+{
+    std::string out_filename = "-";
+    int thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    static void load_engine(engine_t& engine, const std::string& filename)
+    {
+        engine.max_worker_threads = 0; /* the jobs are the parallelism */
+        if(engine.load_nodes_from_disk(filename) == false or engine.graph == nullptr)
+        {
+            throw std::runtime_error("could not load " + filename);
+        }
+        engine.audio_processor.use_convolution = false;
+    }
+
+    /* a step that throws leaves the gas out of bounds, so it is normalized and counted as a fault */
+
+    static void step(engine_t& engine, int& faults)
+    {
+        try
+        {
+            engine.run_sim_once();
+        }
+        catch(const std::exception&)
+        {
+            engine.normalize_all_nodes();
+            faults++;
+        }
+        engine.audio_processor.buffer.clear();
+    }
+
+    /* every job is replaced by what handle_job makes of it. the first job to throw stops the
+     * batch, and is thrown again once every thread is done. returns the wall time in seconds */
+
+    template <typename job_t, typename handle_job_t>
+    double run(std::vector<job_t>& jobs, const std::string& verb, const std::string& noun, handle_job_t handle_job) const
+    {
+        int size = jobs.size();
+        std::atomic<int> next_job = 0;
+        std::atomic<int> done = 0;
+        std::mutex error_mutex;
+        std::exception_ptr error;
+        std::vector<std::thread> threads;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for(int index = 0; index < std::min(thread_count, size); index++)
+        {
+            threads.emplace_back(
+                [&]()
+                {
+                    for(int job = next_job++; job < size; job = next_job++)
+                    {
+                        try
+                        {
+                            jobs[job] = handle_job(jobs[job]);
+                        }
+                        catch(...)
+                        {
+                            std::lock_guard<std::mutex> lock{error_mutex};
+                            error = std::current_exception();
+                            next_job = size;
+                        }
+                        std::cerr << "\r" + verb + " " + std::to_string(++done) + " / " + std::to_string(size) + " " + noun;
+                    }
+                }
+            );
+        }
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        std::cerr << "\n";
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e9;
+    }
+
+    static void write_csv(std::ostream& out, const batch_report_t& report)
+    {
+        int column_count = report.columns.size();
+        for(int column = 0; column < column_count; column++)
+        {
+            out << report.columns[column] << (column + 1 < column_count ? "," : "\n");
+        }
+        for(const std::vector<std::string>& row : report.rows)
+        {
+            for(int column = 0; column < column_count; column++)
+            {
+                out << row[column] << (column + 1 < column_count ? "," : "\n");
+            }
+        }
+    }
+
+    static void write_json(std::ostream& out, const batch_report_t& report)
+    {
+        out << "[\n";
+        int size = report.rows.size();
+        int column_count = report.columns.size();
+        for(int index = 0; index < size; index++)
+        {
+            out << "    {";
+            for(int column = 0; column < column_count; column++)
+            {
+                out << "\"" << report.columns[column] << "\": " << report.rows[index][column] << (column + 1 < column_count ? ", " : "");
+            }
+            out << "}" << (index + 1 < size ? "," : "") << "\n";
+        }
+        out << "]\n";
+    }
+
+    void write(std::ostream& out, const batch_report_t& report) const
+    {
+        if(out_filename.ends_with(".json"))
+        {
+            write_json(out, report);
+        }
+        else
+        {
+            write_csv(out, report);
+        }
+    }
+
+    void write(const batch_report_t& report) const
+    {
+        if(out_filename == "-")
+        {
+            write(std::cout, report);
+        }
+        else
+        {
+            std::ofstream file{out_filename};
+            if(file.is_open() == false)
+            {
+                throw std::runtime_error("could not open " + out_filename);
+            }
+            write(file, report);
+        }
+    }
+};
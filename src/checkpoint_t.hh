@@ -0,0 +1,408 @@
+/* a binary checkpoint of a running engine - its description, every prop to the bit, and
+ * its full engine state, including in-flight gas mail, flames, controller integrals and
+ * the filter and convolution histories. a checkpoint is built in memory and written and
+ * read in one go. the header carries a version and the sizes of the structs copied in
+ * bulk, so a checkpoint from another build is refused rather than misread. one checkpoint
+ * can seed any number of engines */
+
+struct checkpoint_writer_t
+{
+    std::string bytes;
+
+    template <typename T>
+    void write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void write_vector(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write<uint64_t>(values.size());
+        bytes.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    void write_string(const std::string& value)
+    {
+        write<uint64_t>(value.size());
+        bytes.append(value);
+    }
+};
+
+struct checkpoint_reader_t
+{
+    const std::string& bytes;
+    size_t at = 0;
+
+    checkpoint_reader_t(const std::string& bytes)
+        : bytes{bytes}
+        {
+        }
+
+    const char* take(size_t size)
+    {
+        if(size > bytes.size() - at)
+        {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        const char* data = bytes.data() + at;
+        at += size;
+        return data;
+    }
+
+    template <typename T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> read_vector()
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        uint64_t size = read<uint64_t>();
+        if(size > (bytes.size() - at) / sizeof(T))
+        {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        std::vector<T> values(size);
+        if(size > 0)
+        {
+            std::memcpy(values.data(), take(size * sizeof(T)), size * sizeof(T));
+        }
+        return values;
+    }
+
+    static void check(bool is_valid)
+    {
+        if(is_valid == false)
+        {
+            throw std::runtime_error("checkpoint is corrupt");
+        }
+    }
+
+    /* a bool or enum holding a value it cannot name is undefined, so they are checked as
+     * integers before they are read */
+
+    static void check_bool(const char* data)
+    {
+        static_assert(sizeof(bool) == 1);
+        check(static_cast<unsigned char>(*data) <= 1);
+    }
+
+    bool read_bool()
+    {
+        const char* data = take(sizeof(bool));
+        check_bool(data);
+        return *data == 1;
+    }
+
+    template <typename T>
+    T read_enum(T last)
+    {
+        static_assert(std::is_enum_v<T>);
+        using underlying_t = std::underlying_type_t<T>;
+        underlying_t value = read<underlying_t>();
+        check(value >= 0 and value <= static_cast<underlying_t>(last));
+        return static_cast<T>(value);
+    }
+
+    /* indices are used without bounds checks once restored, so they must land inside what they index */
+
+    int read_index(int size)
+    {
+        int index = read<int>();
+        check(index >= 0 and index < size);
+        return index;
+    }
+
+    std::vector<double> read_vector(size_t size)
+    {
+        std::vector<double> values = read_vector<double>();
+        check(values.size() == size);
+        return values;
+    }
+
+    std::string read_string()
+    {
+        uint64_t size = read<uint64_t>();
+        if(size > bytes.size() - at)
+        {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        return std::string(take(size), size);
+    }
+};
+
+struct checkpoint_header_t
+{
+    std::array<char, 8> magic = {'e', 'n', 's', 'i', 'm', '3', 'c', 'k'};
+    uint32_t version = sim_n::checkpoint_version;
+    uint32_t volume_state_size = sizeof(volume_state_t);
+    uint32_t gas_parcel_size = sizeof(gas_parcel_t);
+    uint32_t double_size = sizeof(double);
+
+    bool operator==(const checkpoint_header_t&) const = default;
+};
+
+static_assert(std::is_trivially_copyable_v<checkpoint_header_t>);
+
+struct checkpoint_t
+{
+    std::string description = "";
+    std::string global_props = ""; /* the raw values of the engine's props, packed end to end */
+    std::vector<std::string> props; /* per node in schedule order, the raw values of the node's own props */
+    engine_state_t state;
+
+    static checkpoint_t capture(engine_t& engine)
+    {
+        checkpoint_t checkpoint;
+        std::ostringstream description;
+        engine.save_nodes(description);
+        checkpoint.description = description.str();
+        checkpoint.global_props = write_props(engine.global_prop_table);
+        for(node_t* node : engine.schedule.nodes)
+        {
+            checkpoint.props.push_back(write_props(engine.make_local_prop_table(node)));
+        }
+        checkpoint.state = engine.capture_state();
+        return checkpoint;
+    }
+
+    /* props are written raw - their text is rounded for display and would not read back to the bit */
+
+    static void write_prop(checkpoint_writer_t& writer, const prop_t::real_t& real)
+    {
+        if(std::holds_alternative<double*>(real))
+        {
+            writer.write(*std::get<double*>(real));
+        }
+        else
+        if(std::holds_alternative<int*>(real))
+        {
+            writer.write(*std::get<int*>(real));
+        }
+        else
+        if(std::holds_alternative<bool*>(real))
+        {
+            writer.write(*std::get<bool*>(real));
+        }
+        else
+        if(std::holds_alternative<std::string*>(real))
+        {
+            writer.write_string(*std::get<std::string*>(real));
+        }
+    }
+
+    static std::string write_props(const prop_table_t& prop_table)
+    {
+        checkpoint_writer_t writer;
+        for(const prop_t& prop : prop_table.table)
+        {
+            write_prop(writer, prop.real);
+        }
+        return writer.bytes;
+    }
+
+    static void read_prop(checkpoint_reader_t& reader, const prop_t::real_t& real)
+    {
+        if(std::holds_alternative<double*>(real))
+        {
+            *std::get<double*>(real) = reader.read<double>();
+        }
+        else
+        if(std::holds_alternative<int*>(real))
+        {
+            *std::get<int*>(real) = reader.read<int>();
+        }
+        else
+        if(std::holds_alternative<bool*>(real))
+        {
+            *std::get<bool*>(real) = reader.read_bool();
+        }
+        else
+        if(std::holds_alternative<std::string*>(real))
+        {
+            *std::get<std::string*>(real) = reader.read_string();
+        }
+    }
+
+    static void read_props(const std::string& bytes, const prop_table_t& prop_table)
+    {
+        checkpoint_reader_t reader{bytes};
+        for(const prop_t& prop : prop_table.table)
+        {
+            read_prop(reader, prop.real);
+        }
+    }
+
+    void restore(engine_t& engine) const
+    {
+        engine.load_nodes(description);
+        if(engine.graph == nullptr or engine.schedule.nodes.size() not_eq props.size())
+        {
+            throw std::runtime_error("checkpoint does not describe an engine");
+        }
+        read_props(global_props, engine.global_prop_table);
+        int size = props.size();
+        for(int index = 0; index < size; index++)
+        {
+            read_props(props[index], engine.make_local_prop_table(engine.schedule.nodes[index]));
+        }
+        engine.invalidate_all_nodes();
+        engine.restore_state(state);
+    }
+
+    void write_audio_state(checkpoint_writer_t& writer) const
+    {
+        const audio_state_t& audio = state.audio;
+        writer.write(audio.dc_filter.cutoff_frequency_hz);
+        writer.write(audio.dc_filter.prev_input);
+        writer.write(audio.dc_filter.prev_output);
+        writer.write(audio.convolution_at);
+        writer.write_vector(audio.convolution_buffer);
+        writer.write(audio.brightness_filter.derivative_filter.prev_value);
+        writer.write(audio.brightness_filter.mix_ratio);
+        writer.write_vector(std::vector<double>(audio.agc_filter.window.window.begin(), audio.agc_filter.window.window.end()));
+        writer.write(audio.agc_filter.window.size);
+        writer.write(audio.agc_filter.window.sum);
+        writer.write(audio.agc_filter.gain);
+        writer.write(audio.wet_ratio);
+        writer.write(audio.synthesis_ratio);
+        writer.write(audio.from_value);
+        writer.write(audio.to_value);
+        writer.write_vector(audio.wavetable);
+        writer.write(audio.last_wavetable_index);
+    }
+
+    void read_audio_state(checkpoint_reader_t& reader)
+    {
+        audio_state_t& audio = state.audio;
+        audio.dc_filter.cutoff_frequency_hz = reader.read<double>();
+        audio.dc_filter.prev_input = reader.read<double>();
+        audio.dc_filter.prev_output = reader.read<double>();
+        audio.convolution_at = reader.read_index(sim_n::impulse_size);
+        audio.convolution_buffer = reader.read_vector(sim_n::impulse_size);
+        audio.brightness_filter.derivative_filter.prev_value = reader.read<double>();
+        audio.brightness_filter.mix_ratio = reader.read<double>();
+        std::vector<double> window = reader.read_vector<double>();
+        audio.agc_filter.window.window.assign(window.begin(), window.end());
+        audio.agc_filter.window.size = reader.read<int>();
+        checkpoint_reader_t::check(audio.agc_filter.window.size > 0 and window.size() <= static_cast<size_t>(audio.agc_filter.window.size));
+        audio.agc_filter.window.sum = reader.read<double>();
+        audio.agc_filter.gain = reader.read<double>();
+        audio.wet_ratio = reader.read<double>();
+        audio.synthesis_ratio = reader.read<double>();
+        audio.from_value = reader.read<double>();
+        audio.to_value = reader.read<double>();
+        audio.wavetable = reader.read_vector(sim_n::audio_wavetable_size);
+        audio.last_wavetable_index = reader.read_index(sim_n::audio_wavetable_size);
+    }
+
+    void save(const std::string& filename) const
+    {
+        checkpoint_writer_t writer;
+        writer.write(checkpoint_header_t{});
+        writer.write_string(description);
+        writer.write_string(global_props);
+        writer.write<uint64_t>(props.size());
+        for(const std::string& node_props : props)
+        {
+            writer.write_string(node_props);
+        }
+        writer.write(state.cycle);
+        writer.write(state.crankshaft_theta_r);
+        writer.write(state.crankshaft_last_theta_r);
+        writer.write(state.crankshaft_angular_velocity_r_per_s);
+        writer.write(state.throttle_cable_pull_ratio);
+        writer.write(state.detail_level);
+        writer.write(state.detail_phase);
+        writer.write(state.has_finished_rotation);
+        writer.write(state.cycle_torque_sum_n_m);
+        writer.write(state.cycle_torque_samples);
+        writer.write(state.cycle_mean_torque_n_m);
+        write_audio_state(writer);
+        writer.write<uint64_t>(state.nodes.size());
+        for(const node_state_t& node_state : state.nodes)
+        {
+            writer.write(node_state.volume);
+            writer.write(node_state.gas_mail_cycle);
+            writer.write_vector(node_state.gas_mail);
+            writer.write(node_state.port_open_ratio);
+            writer.write(node_state.port_flow_velocity_m_per_s);
+        }
+        std::ofstream file{filename, std::ios::binary};
+        if(file.is_open() == false)
+        {
+            throw std::runtime_error("could not open " + filename);
+        }
+        file.write(writer.bytes.data(), writer.bytes.size());
+    }
+
+    /* volume states are copied in bulk - the bools among their bytes are checked first */
+
+    static volume_state_t read_volume_state(checkpoint_reader_t& reader)
+    {
+        const char* data = reader.take(sizeof(volume_state_t));
+        checkpoint_reader_t::check_bool(data + offsetof(volume_state_t, flame) + offsetof(flame_t, is_burning));
+        checkpoint_reader_t::check_bool(data + offsetof(volume_state_t, is_enabled));
+        checkpoint_reader_t::check_bool(data + offsetof(volume_state_t, is_rev_limiter_enabled));
+        volume_state_t volume_state;
+        std::memcpy(&volume_state, data, sizeof(volume_state_t));
+        return volume_state;
+    }
+
+    static checkpoint_t load(const std::string& filename)
+    {
+        std::ifstream file{filename, std::ios::binary | std::ios::ate};
+        if(file.is_open() == false)
+        {
+            throw std::runtime_error("could not open " + filename);
+        }
+        std::string bytes(file.tellg(), '\0');
+        file.seekg(0);
+        file.read(bytes.data(), bytes.size());
+        checkpoint_reader_t reader{bytes};
+        if(reader.read<checkpoint_header_t>() not_eq checkpoint_header_t{})
+        {
+            throw std::runtime_error(filename + " is not a checkpoint of this version of ensim3");
+        }
+        checkpoint_t checkpoint;
+        checkpoint.description = reader.read_string();
+        checkpoint.global_props = reader.read_string();
+        uint64_t node_count = reader.read<uint64_t>();
+        for(uint64_t index = 0; index < node_count; index++)
+        {
+            checkpoint.props.push_back(reader.read_string());
+        }
+        engine_state_t& state = checkpoint.state;
+        state.cycle = reader.read<int>();
+        state.crankshaft_theta_r = reader.read<double>();
+        state.crankshaft_last_theta_r = reader.read<double>();
+        state.crankshaft_angular_velocity_r_per_s = reader.read<double>();
+        state.throttle_cable_pull_ratio = reader.read<double>();
+        state.detail_level = reader.read_enum(detail_level_t::minimal);
+        state.detail_phase = reader.read_index(sim_n::reduced_detail_decimation);
+        state.has_finished_rotation = reader.read_bool();
+        state.cycle_torque_sum_n_m = reader.read<double>();
+        state.cycle_torque_samples = reader.read<int>();
+        state.cycle_mean_torque_n_m = reader.read<double>();
+        checkpoint.read_audio_state(reader);
+        uint64_t node_state_count = reader.read<uint64_t>();
+        for(uint64_t index = 0; index < node_state_count; index++)
+        {
+            node_state_t& node_state = state.nodes.emplace_back();
+            node_state.volume = read_volume_state(reader);
+            node_state.gas_mail_cycle = reader.read<int>();
+            node_state.gas_mail = reader.read_vector<gas_parcel_t>();
+            node_state.port_open_ratio = reader.read<double>();
+            node_state.port_flow_velocity_m_per_s = reader.read<double>();
+        }
+        return checkpoint;
+    }
+};
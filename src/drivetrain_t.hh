@@ -0,0 +1,129 @@
+/* everything that turns with the crank. inertia only changes with props and with the pistons
+ * that come and go, so it is summed once and cached until the engine invalidates it - each
+ * piston is kept as a cylinder made from its props, so a sample reads a piston for nothing but
+ * its pressure. torques are summed in one pass, the crank, camshaft, flywheel and starter first
+ * and then the pistons, the order the rotational masses were always summed in */
+
+struct drivetrain_t
+{
+    crankshaft_t& crankshaft;
+    camshaft_t& camshaft;
+    flywheel_t& flywheel;
+    starter_motor_t& starter_motor;
+    std::array<const rotational_mass_t*, 4> masses;
+    const std::vector<piston_t*>& pistons;
+    std::vector<cylinder_t> cylinders; /* one per piston, in the same order */
+    double moment_of_inertia_kg_per_m2 = 0.0;
+    bool is_valid = false;
+    bool is_live = false; /* live props write what is cached, so it is made again every cycle */
+
+    drivetrain_t(crankshaft_t& crankshaft, camshaft_t& camshaft, flywheel_t& flywheel, starter_motor_t& starter_motor, const std::vector<piston_t*>& pistons)
+        : crankshaft{crankshaft}
+        , camshaft{camshaft}
+        , flywheel{flywheel}
+        , starter_motor{starter_motor}
+        , masses{&crankshaft, &camshaft, &flywheel, &starter_motor}
+        , pistons{pistons}
+        {
+        }
+
+    void invalidate()
+    {
+        is_valid = false;
+    }
+
+    template <typename T>
+    static bool is_within(const T& object, const double* real)
+    {
+        const char* first = reinterpret_cast<const char*>(&object);
+        const char* at = reinterpret_cast<const char*>(real);
+        return std::less_equal<const char*>{}(first, at) and std::less<const char*>{}(at, first + sizeof(T));
+    }
+
+    /* anything in the other masses may go into their inertia, but only some of a piston's props do */
+
+    bool is_input(const double* real) const
+    {
+        if(is_within(crankshaft, real) or is_within(camshaft, real) or is_within(flywheel, real) or is_within(starter_motor, real))
+        {
+            return true;
+        }
+        return std::any_of(
+            pistons.begin(), pistons.end(),
+            [real](const piston_t* piston)
+            {
+                return piston->is_cylinder_input(real);
+            }
+        );
+    }
+
+    void validate()
+    {
+        if(is_valid and cylinders.size() == pistons.size())
+        {
+            return;
+        }
+        cylinders.clear();
+        moment_of_inertia_kg_per_m2 = 0.0;
+        for(const rotational_mass_t* mass : masses)
+        {
+            moment_of_inertia_kg_per_m2 += mass->calc_moment_of_inertia_kg_per_m2();
+        }
+        for(const piston_t* piston : pistons)
+        {
+            cylinders.push_back(piston->calc_cylinder());
+            moment_of_inertia_kg_per_m2 += cylinders.back().moment_of_inertia_kg_per_m2;
+        }
+        is_valid = true;
+    }
+
+    double calc_moment_of_inertia_kg_per_m2()
+    {
+        validate();
+        return moment_of_inertia_kg_per_m2;
+    }
+
+    void calc_torques_n_m(double& applied_torque_n_m, double& friction_torque_n_m)
+    {
+        validate();
+        applied_torque_n_m = 0.0;
+        friction_torque_n_m = 0.0;
+        for(const rotational_mass_t* mass : masses)
+        {
+            applied_torque_n_m += mass->calc_applied_torque_n_m();
+            friction_torque_n_m += mass->calc_friction_torque_n_m();
+        }
+        double theta_r = crankshaft.theta_r;
+        double angular_velocity_r_per_s = crankshaft.angular_velocity_r_per_s;
+        int size = cylinders.size();
+        for(int index = 0; index < size; index++)
+        {
+            const cylinder_t& cylinder = cylinders[index];
+            applied_torque_n_m += cylinder.calc_applied_torque_n_m(pistons[index]->calc_static_gauge_pressure_pa(), theta_r, angular_velocity_r_per_s);
+            friction_torque_n_m += cylinder.calc_friction_torque_n_m(angular_velocity_r_per_s);
+        }
+    }
+
+    double calc_applied_torque_n_m()
+    {
+        double applied_torque_n_m = 0.0;
+        double friction_torque_n_m = 0.0;
+        calc_torques_n_m(applied_torque_n_m, friction_torque_n_m);
+        return applied_torque_n_m;
+    }
+
+    double calc_friction_torque_n_m()
+    {
+        validate();
+        double friction_torque_n_m = 0.0;
+        for(const rotational_mass_t* mass : masses)
+        {
+            friction_torque_n_m += mass->calc_friction_torque_n_m();
+        }
+        for(const cylinder_t& cylinder : cylinders)
+        {
+            friction_torque_n_m += cylinder.calc_friction_torque_n_m(crankshaft.angular_velocity_r_per_s);
+        }
+        return friction_torque_n_m;
+    }
+};
@@ -0,0 +1,260 @@
+/* ensim3 --dyno [file] [--throttles from:to:count] [--speeds from:to:count] [--settle-cycles max]
+ *               [--tolerance ratio] [--measure-cycles n] [--threads n] [--warm] [--out map.csv|map.json|-]
+ *
+ * maps an engine on a virtual dyno - every throttle position and crank speed pair runs as
+ * its own headless engine with the crank held at speed by an ideal brake. once settled, the
+ * applied torque, power, volumetric efficiency and wideband air fuel ratio are averaged
+ * over whole four stroke cycles. measuring starts once the point's cycles repeat to within
+ * the tolerance, or at the settle cycle cap, whichever comes first. every point starts
+ * cold, so a map repeats digit for digit. with --warm settled points are cached and later
+ * points start from the nearest cached one - faster, but which points are cached first
+ * depends on thread timing, so warm maps do not repeat. points are spread across a pool of
+ * threads and written in grid order as csv, or as json when the output ends in .json */
+
+struct dyno_point_t
+{
+    double throttle = 0.0;
+    double angular_velocity_r_per_s = 0.0;
+    double torque_n_m = 0.0;
+    double power_w = 0.0;
+    double volumetric_efficiency = 0.0;
+    double air_fuel_mass_ratio = 0.0;
+    int settle_cycles = 0;
+    bool is_settled = false;
+    bool is_warm_started = false;
+    int faults = 0;
+};
+
+struct dyno_t
+{
+    std::string filename = "engines/test.ensim3";
+    std::vector<double> throttles = parse_range("0.1:1.0:10");
+    std::vector<double> angular_velocities_r_per_s = parse_range("100:800:8");
+    int settle_cycles = 100;
+    double tolerance = sim_n::steady_state_tolerance;
+    int measure_cycles = 10;
+    batch_t batch;
+    bool use_warm_starts = false;
+    warm_start_cache_t warm_start_cache;
+
+    dyno_t(const std::vector<std::string>& args)
+    {
+        int size = args.size();
+        for(int i = 0; i < size; i++)
+        {
+            const std::string& arg = args[i];
+            bool has_value = i + 1 < size;
+            if(arg == "--dyno")
+            {
+                if(has_value and args[i + 1].starts_with("--") == false)
+                {
+                    filename = args[++i];
+                }
+            }
+            else
+            if(arg == "--throttles" and has_value)
+            {
+                throttles = parse_range(args[++i]);
+            }
+            else
+            if(arg == "--speeds" and has_value)
+            {
+                angular_velocities_r_per_s = parse_range(args[++i]);
+            }
+            else
+            if(arg == "--settle-cycles" and has_value)
+            {
+                settle_cycles = std::stoi(args[++i]);
+            }
+            else
+            if(arg == "--tolerance" and has_value)
+            {
+                tolerance = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--measure-cycles" and has_value)
+            {
+                measure_cycles = std::max(1, std::stoi(args[++i]));
+            }
+            else
+            if(arg == "--threads" and has_value)
+            {
+                batch.thread_count = std::max(1, std::stoi(args[++i]));
+            }
+            else
+            if(arg == "--warm")
+            {
+                use_warm_starts = true;
+            }
+            else
+            if(arg == "--out" and has_value)
+            {
+                batch.out_filename = args[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("unknown or incomplete argument: " + arg);
+            }
+        }
+    }
+
+    /* "from:to:count" spaced evenly, or a single value */
+
+    static std::vector<double> parse_range(const std::string& range)
+    {
+        std::vector<std::string> tokens;
+        std::stringstream stream{range};
+        std::string token = "";
+        while(std::getline(stream, token, ':'))
+        {
+            tokens.push_back(token);
+        }
+        if(tokens.size() == 1)
+        {
+            return {std::stod(tokens[0])};
+        }
+        if(tokens.size() not_eq 3)
+        {
+            throw std::invalid_argument("expected from:to:count, got: " + range);
+        }
+        double from = std::stod(tokens[0]);
+        double to = std::stod(tokens[1]);
+        int count = std::stoi(tokens[2]);
+        if(count < 1)
+        {
+            throw std::invalid_argument("range needs at least one point: " + range);
+        }
+        std::vector<double> values;
+        for(int index = 0; index < count; index++)
+        {
+            values.push_back(count == 1 ? from : from + (to - from) * index / (count - 1));
+        }
+        return values;
+    }
+
+    dyno_point_t measure(double throttle, double angular_velocity_r_per_s)
+    {
+        dyno_point_t point{throttle, angular_velocity_r_per_s};
+        engine_t engine;
+        batch_t::load_engine(engine, filename);
+        engine.starter_motor.is_enabled = false;
+        engine.throttle_cable.pull_ratio_setpoint = throttle;
+        engine.held_angular_velocity_r_per_s = angular_velocity_r_per_s;
+        size_t engine_hash = engine.calc_engine_hash();
+        operating_point_t operating_point{throttle, angular_velocity_r_per_s};
+        if(use_warm_starts)
+        {
+            std::shared_ptr<const engine_state_t> state = warm_start_cache.find(engine_hash, operating_point);
+            if(state)
+            {
+                engine.restore_state(*state);
+                point.is_warm_started = true;
+            }
+        }
+        steady_state_detector_t detector;
+        detector.tolerance = tolerance;
+        bool is_measuring = false;
+        int cycles = 0;
+        int samples = 0;
+        double torque_sum_n_m = 0.0;
+        double air_fuel_mass_ratio_sum = 0.0;
+        double volumetric_efficiency_sum = 0.0;
+        int piston_count = std::max(1, static_cast<int>(engine.pistons.size()));
+        std::vector<double> peak_volumetric_efficiencies(engine.pistons.size(), 0.0);
+        while(cycles < measure_cycles)
+        {
+            batch_t::step(engine, point.faults);
+            if(not is_measuring)
+            {
+                /* settle until the cycles repeat, or give up at the cap and measure anyway */
+                if(detector.sample(engine) and (detector.is_converged() or detector.cycles >= settle_cycles))
+                {
+                    is_measuring = true;
+                    point.settle_cycles = detector.cycles;
+                    point.is_settled = detector.is_converged();
+                }
+                continue;
+            }
+            if(engine.crankshaft.finished_rotation())
+            {
+                /* mol balance nets out to zero once the exhaust stroke is done, so
+                 * a cycle's efficiency is the peak trapped charge of each piston */
+                for(double& peak_volumetric_efficiency : peak_volumetric_efficiencies)
+                {
+                    volumetric_efficiency_sum += peak_volumetric_efficiency / piston_count;
+                    peak_volumetric_efficiency = 0.0;
+                }
+                cycles++;
+                continue;
+            }
+            double air_fuel_mass_ratio = 0.0;
+            int size = engine.pistons.size();
+            for(int index = 0; index < size; index++)
+            {
+                piston_t* piston = engine.pistons[index];
+                peak_volumetric_efficiencies[index] = std::max(peak_volumetric_efficiencies[index], piston->calc_volumetric_efficiency());
+                air_fuel_mass_ratio += piston->calc_equivalent_air_fuel_mass_ratio();
+            }
+            torque_sum_n_m += engine.calc_applied_torque_n_m();
+            air_fuel_mass_ratio_sum += air_fuel_mass_ratio / piston_count;
+            samples++;
+        }
+        point.torque_n_m = torque_sum_n_m / samples;
+        point.power_w = point.torque_n_m * angular_velocity_r_per_s;
+        point.volumetric_efficiency = volumetric_efficiency_sum / measure_cycles;
+        point.air_fuel_mass_ratio = air_fuel_mass_ratio_sum / samples;
+        if(use_warm_starts and point.is_settled)
+        {
+            warm_start_cache.store(engine_hash, operating_point, engine.capture_state());
+        }
+        return point;
+    }
+
+    static batch_report_t make_report(const std::vector<dyno_point_t>& points)
+    {
+        batch_report_t report;
+        report.columns = {"throttle", "angular_velocity_r_per_s", "rpm", "torque_n_m", "power_w", "volumetric_efficiency", "air_fuel_mass_ratio", "settle_cycles", "is_settled", "is_warm_started", "faults"};
+        for(const dyno_point_t& point : points)
+        {
+            report.rows.push_back({
+                double_to_string(point.throttle, 4),
+                double_to_string(point.angular_velocity_r_per_s, 4),
+                double_to_string(point.angular_velocity_r_per_s * 60.0 / (2.0 * M_PI), 1),
+                double_to_string(point.torque_n_m, 6),
+                double_to_string(point.power_w, 6),
+                double_to_string(point.volumetric_efficiency, 6),
+                double_to_string(point.air_fuel_mass_ratio, 6),
+                std::to_string(point.settle_cycles),
+                point.is_settled ? "true" : "false",
+                point.is_warm_started ? "true" : "false",
+                std::to_string(point.faults),
+            });
+        }
+        return report;
+    }
+
+    int run()
+    {
+        std::vector<dyno_point_t> points;
+        for(double throttle : throttles)
+        {
+            for(double angular_velocity_r_per_s : angular_velocities_r_per_s)
+            {
+                points.push_back({throttle, angular_velocity_r_per_s});
+            }
+        }
+        double wall_time_s = batch.run(
+            points, "measured", "points",
+            [this](const dyno_point_t& point)
+            {
+                return measure(point.throttle, point.angular_velocity_r_per_s);
+            }
+        );
+        batch.write(make_report(points));
+        std::cerr
+            << "mapped " << points.size() << " points of " << filename
+            << " on " << batch.thread_count << " thread(s) in " << double_to_string(wall_time_s, 2) << " s\n";
+        return 0;
+    }
+
+};
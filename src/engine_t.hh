@@ -0,0 +1,990 @@
+/* the simulation proper - everything needed to load, run, and save an engine
+ * without a window or an audio device, so it can be driven by the sdl frontend
+ * or run headless as fast as the cpu allows */
+
+/* an edge's flux for one step - which way the gas flows and the parcel it carries */
+
+struct gas_flux_t
+{
+    volume_t* source = nullptr;
+    volume_t* destination = nullptr;
+    std::optional<gas_parcel_t> parcel;
+};
+
+/* how closely an engine is simulated - background engines trade fidelity for cpu */
+
+enum class detail_level_t
+{
+    full, reduced, minimal
+};
+
+detail_level_t parse_detail_level(const std::string& name)
+{
+    if(name == "full")
+    {
+        return detail_level_t::full;
+    }
+    else
+    if(name == "reduced")
+    {
+        return detail_level_t::reduced;
+    }
+    else
+    if(name == "minimal")
+    {
+        return detail_level_t::minimal;
+    }
+    throw std::invalid_argument("expected full, reduced or minimal, got: " + name);
+}
+
+/* a snapshot of a running engine - its nodes are kept in compiled schedule order,
+ * so a snapshot only fits an engine loaded from the same description */
+
+struct node_state_t
+{
+    volume_state_t volume;
+    int gas_mail_cycle = 0;
+    std::vector<gas_parcel_t> gas_mail;
+    double port_open_ratio = 0.0;
+    double port_flow_velocity_m_per_s = 0.0;
+};
+
+struct engine_state_t
+{
+    int cycle = 0;
+    double crankshaft_theta_r = 0.0;
+    double crankshaft_last_theta_r = 0.0;
+    double crankshaft_angular_velocity_r_per_s = 0.0;
+    double throttle_cable_pull_ratio = 0.0;
+    detail_level_t detail_level = detail_level_t::full;
+    int detail_phase = 0;
+    bool has_finished_rotation = false;
+    double cycle_torque_sum_n_m = 0.0;
+    int cycle_torque_samples = 0;
+    double cycle_mean_torque_n_m = 0.0;
+    audio_state_t audio;
+    std::vector<node_state_t> nodes;
+};
+
+struct engine_t
+{
+    int cycle = 0;
+    int x_tiles = 38;
+    int y_tiles = 20;
+    gas_store_t gas_store{x_tiles * y_tiles + 1}; /* one spare slot for the node being polymorphed */
+    plot_panel_t plot_panel;
+    crankshaft_t crankshaft;
+    camshaft_t camshaft{crankshaft};
+    audio_processor_t audio_processor{crankshaft}; /* todo: collect audio from multiple collectors (like dual exhaust) */
+    flywheel_t flywheel;
+    starter_motor_t starter_motor{crankshaft, flywheel};
+    throttle_cable_t throttle_cable;
+    prop_formulas_t global_formulas;
+    prop_table_t global_prop_table = make_global_prop_table(); /* the one table the engine wide props are looked up in */
+    std::vector<piston_t*> pistons;
+    std::vector<injector_t*> injectors;
+    std::vector<throttle_port_t*> throttle_ports;
+    node_table_t node_table{x_tiles, y_tiles, pistons, injectors, throttle_ports};
+    drivetrain_t drivetrain{crankshaft, camshaft, flywheel, starter_motor, pistons};
+    node_t* graph = nullptr;
+    schedule_t schedule;
+    std::vector<gas_flux_t> fluxes;
+    std::vector<double> flux_debit_moles = std::vector<double>(gas_store.moles.size(), 0.0); /* per gas store slot, for balancing */
+    int max_worker_threads = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    std::optional<double> held_angular_velocity_r_per_s; /* dyno - an ideal brake holds the crank at speed */
+    detail_level_t detail_level = detail_level_t::full;
+    int detail_phase = 0; /* reduced - steps since the last pass over the graph */
+    bool has_finished_rotation = false; /* since the last pass over the graph */
+    double cycle_torque_sum_n_m = 0.0;
+    int cycle_torque_samples = 0;
+    double cycle_mean_torque_n_m = 0.0; /* less the starter - drives the crank at minimal detail */
+    prop_graph_t prop_graph;
+    int prop_revision = 0; /* bumped whenever props move or are bound again, so shown tables know to be made again */
+
+    void compile_schedule()
+    {
+        drivetrain.invalidate(); /* pistons come and go with the nodes */
+        schedule.compile(graph);
+        fluxes.resize(schedule.edges.size());
+        /* a handful of branches is cheaper to run serially than to hand out every step */
+        int branch_count = schedule.branches.size();
+        int worker_count = 0;
+        if(branch_count >= sim_n::parallel_branch_threshold)
+        {
+            worker_count = std::min(max_worker_threads, branch_count - 1);
+        }
+        schedule.workers.resize(worker_count);
+        std::vector<int> indices;
+        for(node_t* node : schedule.nodes)
+        {
+            indices.push_back(node->volume->index);
+        }
+        gas_store.arrange(indices);
+        /* gas fields moved so the bound props reading them must be compiled again */
+        bind_props();
+    }
+
+    static void apply_formulas(prop_table_t& prop_table, const prop_formulas_t& formulas)
+    {
+        for(const auto& [key, text] : formulas)
+        {
+            if(prop_t* prop = prop_table.get(key))
+            {
+                prop->set_formula_text(text);
+            }
+        }
+    }
+
+    /* props shared by the whole engine rather than owned by a node */
+
+    prop_table_t make_global_prop_table()
+    {
+        prop_table_t prop_table = crankshaft.get_prop_table()
+            + camshaft.get_prop_table()
+            + flywheel.get_prop_table()
+            + throttle_cable.get_prop_table()
+            + starter_motor.get_prop_table();
+        apply_formulas(prop_table, global_formulas);
+        return prop_table;
+    }
+
+    prop_table_t make_local_prop_table(node_t* node)
+    {
+        prop_table_t prop_table = node->port->get_prop_table() + node->volume->get_prop_table();
+        apply_formulas(prop_table, node->formulas);
+        return prop_table;
+    }
+
+    /* what is shown for a node - its own props and then the engine's */
+
+    prop_table_t make_prop_table(node_t* node)
+    {
+        return make_local_prop_table(node) + make_global_prop_table();
+    }
+
+    /* node expressions read the node's props first and then the engine's - engine expressions only the engine's */
+
+    prop_t::resolve_t make_resolve(prop_table_t* local_prop_table)
+    {
+        return [this, local_prop_table](std::string_view key)
+        {
+            const double* real = local_prop_table ? local_prop_table->get_double(key) : nullptr;
+            return real ? real : global_prop_table.get_double(key);
+        };
+    }
+
+    void bind_formulas(prop_formulas_t& formulas, node_t* node, prop_table_t& prop_table, prop_table_t* local_prop_table)
+    {
+        std::vector<std::string_view> constants;
+        for(const auto& [key, text] : formulas)
+        {
+            prop_t* prop = prop_table.get(key);
+            if(prop == nullptr or std::holds_alternative<double*>(prop->real) == false)
+            {
+                constants.push_back(key);
+                continue;
+            }
+            prop->set_formula_text(text);
+            expression_parser_t parser{make_resolve(local_prop_table)};
+            expression_t expression = parser.compile(prop->formula);
+            if(prop->is_live or expression.reads_props())
+            {
+                prop_graph.add(&formulas, node, *prop, std::move(expression));
+            }
+            else
+            {
+                constants.push_back(key); /* a constant expression from a file */
+            }
+        }
+        for(std::string_view key : constants)
+        {
+            formulas.erase(key);
+        }
+    }
+
+    /* bound props are compiled against the props of their node, and so are compiled again
+     * whenever the gas fields move. binding evaluates nothing - props that read each other
+     * in a cycle are unbound and keep their values */
+
+    void bind_props()
+    {
+        prop_revision++;
+        prop_graph.clear();
+        bind_formulas(global_formulas, nullptr, global_prop_table, nullptr);
+        node_table.iterate(
+            [this](node_t* node)
+            {
+                if(node->formulas.empty() == false)
+                {
+                    prop_table_t prop_table = make_local_prop_table(node);
+                    bind_formulas(node->formulas, node, prop_table, &prop_table);
+                }
+            }
+        );
+        std::vector<int> cyclic = prop_graph.link();
+        if(cyclic.empty() == false)
+        {
+            for(int index : cyclic)
+            {
+                bound_prop_t& bound_prop = prop_graph.bound_props[index];
+                bound_prop.formulas->erase(bound_prop.key);
+            }
+            bind_props();
+            return;
+        }
+        drivetrain.is_live = std::any_of(
+            prop_graph.cycle_order.begin(), prop_graph.cycle_order.end(),
+            [this](int index)
+            {
+                return drivetrain.is_input(prop_graph.bound_props[index].real);
+            }
+        );
+    }
+
+    /* a commit evaluates the prop and then only the bound props downstream of it. an expression
+     * that would read its own prop, however indirectly, is evaluated once and left unbound */
+
+    void commit_prop(node_t* node, std::string_view key, const std::string& value)
+    {
+        prop_table_t local_prop_table = make_local_prop_table(node);
+        prop_table_t* resolve_prop_table = &local_prop_table;
+        prop_formulas_t* formulas = &node->formulas;
+        prop_t* prop = local_prop_table.get(key);
+        if(prop == nullptr)
+        {
+            resolve_prop_table = nullptr;
+            formulas = &global_formulas;
+            prop = global_prop_table.get(key);
+        }
+        if(prop == nullptr)
+        {
+            return;
+        }
+        bool was_bound = formulas->contains(prop->key);
+        prop->value = value;
+        prop->commit(make_resolve(resolve_prop_table));
+        if(prop->is_bound())
+        {
+            expression_parser_t parser{make_resolve(resolve_prop_table)};
+            if(prop_graph.reads(parser.compile(prop->formula), std::get<double*>(prop->real)))
+            {
+                prop->unbind();
+            }
+        }
+        if(prop->is_bound())
+        {
+            (*formulas)[prop->key] = prop->get_formula_text();
+        }
+        else
+        {
+            formulas->erase(prop->key);
+        }
+        if(was_bound or prop->is_bound())
+        {
+            bind_props();
+        }
+        if(std::holds_alternative<double*>(prop->real))
+        {
+            prop_graph.update(std::get<double*>(prop->real));
+        }
+        prop_revision++;
+        invalidate_all_nodes();
+    }
+
+    /* v2 engine files write the crankshaft, camshaft, flywheel, throttle cable and starter
+     * props once in a global section - every node's prop table carries them after its own:
+     *
+     *     version:2
+     *     global:key=value,...
+     *     make:uid:x_tile:y_tile:name:key=value,...
+     *     join:parent_uid:child_uid
+     *
+     * v1 files have no version or global section and repeat the global props on every make */
+
+    void save_nodes(std::ostream& file)
+    {
+        int uid = 0;
+        std::unordered_map<node_t*, int> node_to_uid;
+        file << "version" << ":" << sim_n::engine_file_version << "\n";
+        file << "global" << ":";
+        prop_table_t global_props = make_global_prop_table();
+        global_props.sync();
+        for(const prop_t& prop : global_props.table)
+        {
+            file << prop.key << "=" << prop.value << ",";
+        }
+        file << "\n";
+        graph->iterate(
+            [this, &file, &uid, &node_to_uid](node_t* parent)
+            {
+                file
+                    << "make" << ":"
+                    << std::to_string(uid) << ":"
+                    << std::to_string(parent->x_tile) << ":"
+                    << std::to_string(parent->y_tile) << ":"
+                    << parent->volume->name << ":";
+                prop_table_t props = make_local_prop_table(parent);
+                props.sync();
+                for(const prop_t& prop : props.table)
+                {
+                    file << prop.key << "=" << prop.value << ",";
+                }
+                file << "\n";
+                node_to_uid[parent] = uid++;
+                return false;
+            });
+        graph->iterate(
+            [&file, &node_to_uid](node_t* parent, node_t* child)
+            {
+                file
+                    << "join" << ":"
+                    << std::to_string(node_to_uid[parent]) << ":"
+                    << std::to_string(node_to_uid[child]) << "\n";
+                return false;
+            });
+    }
+
+    bool save_nodes_to_disk(const std::string& filename)
+    {
+        std::ofstream file{filename};
+        if(file.is_open())
+        {
+            save_nodes(file);
+            return true;
+        }
+        return false;
+    }
+
+    /* splits the next field off the front of text */
+
+    static std::string_view next_field(std::string_view& text, char delimiter)
+    {
+        size_t pos = text.find(delimiter);
+        std::string_view field = text.substr(0, pos);
+        text = pos == std::string_view::npos ? std::string_view{} : text.substr(pos + 1);
+        return field;
+    }
+
+    static int parse_int(std::string_view field)
+    {
+        int value = 0;
+        const char* last = field.data() + field.size();
+        std::from_chars_result result = std::from_chars(field.data(), last, value);
+        if(result.ec not_eq std::errc{} or result.ptr not_eq last)
+        {
+            throw std::invalid_argument("expected an integer, got: " + std::string{field});
+        }
+        return value;
+    }
+
+    /* a key the table does not carry is an engine prop, as v1 files write on every node */
+
+    void unpack_props(std::string_view props, prop_table_t& prop_table, prop_formulas_t& formulas)
+    {
+        while(props.empty() == false)
+        {
+            std::string_view pair = next_field(props, ',');
+            size_t pos = pair.find('=');
+            if(pos == std::string_view::npos)
+            {
+                continue;
+            }
+            std::string_view key = pair.substr(0, pos);
+            prop_formulas_t* prop_formulas = &formulas;
+            prop_t* prop = prop_table.get(key);
+            if(prop == nullptr)
+            {
+                prop_formulas = &global_formulas;
+                prop = global_prop_table.get(key);
+            }
+            if(prop)
+            {
+                prop->assign(pair.substr(pos + 1));
+                if(prop->is_bound())
+                {
+                    (*prop_formulas)[prop->key] = prop->get_formula_text();
+                }
+            }
+        }
+    }
+
+    /* a single pass over the text, which is read in place */
+
+    void load_nodes(std::string_view text)
+    {
+        node_table.clear();
+        global_formulas.clear();
+        std::unordered_map<int, node_t*> uid_to_node;
+        while(text.empty() == false)
+        {
+            std::string_view line = next_field(text, '\n');
+            std::string_view command = next_field(line, ':');
+            if(command == "make")
+            {
+                int uid = parse_int(next_field(line, ':'));
+                int x_tile = parse_int(next_field(line, ':'));
+                int y_tile = parse_int(next_field(line, ':'));
+                std::string name{next_field(line, ':')};
+                std::unique_ptr<node_t> node = make_node(x_tile, y_tile, name);
+                prop_table_t prop_table = make_local_prop_table(node.get());
+                unpack_props(line, prop_table, node->formulas);
+                node->volume->invalidate_composition();
+                uid_to_node[uid] = node.get();
+                node_table.create_node(x_tile, y_tile, std::move(node));
+            }
+            else
+            if(command == "join")
+            {
+                int parent_uid = parse_int(next_field(line, ':'));
+                int child_uid = parse_int(next_field(line, ':'));
+                node_t* parent = uid_to_node[parent_uid];
+                node_t* child = uid_to_node[child_uid];
+                parent->add_child(child);
+            }
+            else
+            if(command == "global")
+            {
+                unpack_props(line, global_prop_table, global_formulas);
+            }
+            else
+            if(command == "version")
+            {
+                int version = parse_int(line);
+                if(version > sim_n::engine_file_version)
+                {
+                    throw std::runtime_error("engine file version " + std::to_string(version) + " is newer than this ensim3 reads");
+                }
+            }
+        }
+        graph = uid_to_node[0];
+        compile_schedule();
+        prop_graph.update_all();
+    }
+
+    bool load_nodes_from_disk(const std::string& filename)
+    {
+        std::ifstream file{filename, std::ios::binary};
+        std::string text{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+        load_nodes(text);
+        return file.is_open();
+    }
+
+    std::unique_ptr<node_t> make_node(int x_tile, int y_tile, const std::string& name)
+    {
+        std::unique_ptr<volume_t> volume;
+        std::unique_ptr<port_t> port;
+        if(name == "source")
+        {
+            volume = std::make_unique<source_t>(gas_store);
+            port = std::make_unique<port_t>();
+        }
+        else
+        if(name == "throttle")
+        {
+            volume = std::make_unique<throttle_t>(gas_store, pistons, injectors, crankshaft);
+            port = std::make_unique<throttle_port_t>(throttle_cable);
+        }
+        else
+        if(name == "plenum")
+        {
+            volume = std::make_unique<plenum_t>(gas_store);
+            port = std::make_unique<port_t>();
+        }
+        else
+        if(name == "injector")
+        {
+            volume = std::make_unique<injector_t>(gas_store, throttle_cable);
+            port = std::make_unique<actuated_port_t>(camshaft, 0.0 * M_PI, M_PI);
+        }
+        else
+        if(name == "piston")
+        {
+            volume = std::make_unique<piston_t>(gas_store, camshaft);
+            port = std::make_unique<actuated_port_t>(camshaft, 3.0 * M_PI, M_PI);
+        }
+        else
+        if(name == "collector")
+        {
+            volume = std::make_unique<collector_t>(gas_store, audio_processor, crankshaft);
+            port = std::make_unique<port_t>();
+        }
+        else
+        if(name == "exhaust")
+        {
+            volume = std::make_unique<exhaust_t>(gas_store);
+            port = std::make_unique<port_t>();
+        }
+        else
+        if(name == "sink")
+        {
+            volume = std::make_unique<sink_t>(gas_store);
+            port = std::make_unique<port_t>();
+        }
+        else
+        {
+            volume = std::make_unique<volume_t>(gas_store);
+            port = std::make_unique<port_t>();
+        }
+        std::unique_ptr<node_t> node = std::make_unique<node_t>(x_tile, y_tile, std::move(volume), std::move(port));
+        return node;
+    }
+
+    /* props that change as the engine runs rather than describe it */
+
+    static bool is_state_prop(std::string_view key)
+    {
+        return key.starts_with("gas_")
+            or key == "crankshaft_theta_r"
+            or key == "crankshaft_angular_velocity_r_per_s"
+            or key == "throttle_cable_pull_ratio_setpoint"
+            or key == "starter_motor_is_enabled"
+            or key == "port_open_ratio"
+            or key == "sparkplug_is_enabled"
+            or key == "injector_is_enabled";
+    }
+
+    /* identifies the engine by its graph and props, so snapshots are only restored where they fit */
+
+    size_t calc_engine_hash()
+    {
+        std::string description = "";
+        graph->iterate(
+            [this, &description](node_t* parent)
+            {
+                prop_table_t props = make_prop_table(parent);
+                props.sync();
+                description += std::to_string(parent->x_tile) + ":" + std::to_string(parent->y_tile) + ":" + parent->volume->name + ":";
+                for(const prop_t& prop : props.table)
+                {
+                    if(is_state_prop(prop.key) == false)
+                    {
+                        description += std::string{prop.key} + "=" + prop.value + ",";
+                    }
+                }
+                description += "\n";
+                return false;
+            },
+            [&description](node_t* parent, node_t* child)
+            {
+                description += std::to_string(parent->x_tile) + ":" + std::to_string(parent->y_tile) + ">";
+                description += std::to_string(child->x_tile) + ":" + std::to_string(child->y_tile) + "\n";
+            }
+        );
+        return std::hash<std::string>{}(description);
+    }
+
+    engine_state_t capture_state() const
+    {
+        engine_state_t state;
+        state.cycle = cycle;
+        state.crankshaft_theta_r = crankshaft.theta_r;
+        state.crankshaft_last_theta_r = crankshaft.last_theta_r;
+        state.crankshaft_angular_velocity_r_per_s = crankshaft.angular_velocity_r_per_s;
+        state.throttle_cable_pull_ratio = throttle_cable.pull_ratio;
+        state.detail_level = detail_level;
+        state.detail_phase = detail_phase;
+        state.has_finished_rotation = has_finished_rotation;
+        state.cycle_torque_sum_n_m = cycle_torque_sum_n_m;
+        state.cycle_torque_samples = cycle_torque_samples;
+        state.cycle_mean_torque_n_m = cycle_mean_torque_n_m;
+        audio_processor.capture_state(state.audio);
+        for(node_t* node : schedule.nodes)
+        {
+            node_state_t& node_state = state.nodes.emplace_back();
+            node->volume->capture_state(node_state.volume);
+            node_state.gas_mail_cycle = node->volume->gas_mail.next_cycle;
+            node_state.gas_mail = node->volume->gas_mail.calc_parcels();
+            node_state.port_open_ratio = node->port->open_ratio;
+            node_state.port_flow_velocity_m_per_s = node->port->flow_velocity_m_per_s.get();
+        }
+        return state;
+    }
+
+    void restore_state(const engine_state_t& state)
+    {
+        int size = schedule.nodes.size();
+        if(static_cast<int>(state.nodes.size()) not_eq size)
+        {
+            throw std::runtime_error("engine state does not fit this engine");
+        }
+        cycle = state.cycle;
+        crankshaft.theta_r = state.crankshaft_theta_r;
+        crankshaft.last_theta_r = state.crankshaft_last_theta_r;
+        crankshaft.angular_velocity_r_per_s = state.crankshaft_angular_velocity_r_per_s;
+        throttle_cable.pull_ratio = state.throttle_cable_pull_ratio;
+        set_detail_level(state.detail_level);
+        detail_phase = state.detail_phase;
+        has_finished_rotation = state.has_finished_rotation;
+        cycle_torque_sum_n_m = state.cycle_torque_sum_n_m;
+        cycle_torque_samples = state.cycle_torque_samples;
+        cycle_mean_torque_n_m = state.cycle_mean_torque_n_m;
+        audio_processor.restore_state(state.audio);
+        /* crank first - pistons rig themselves to its angle */
+        for(int index = 0; index < size; index++)
+        {
+            node_t* node = schedule.nodes[index];
+            const node_state_t& node_state = state.nodes[index];
+            node->volume->restore_state(node_state.volume);
+            node->volume->gas_mail.assign(node_state.gas_mail_cycle, node_state.gas_mail);
+            node->port->open_ratio = node_state.port_open_ratio;
+            node->port->flow_velocity_m_per_s.set(node_state.port_flow_velocity_m_per_s);
+        }
+    }
+
+    int count_selected_nodes()
+    {
+        int count = 0;
+        node_table.iterate(
+            [&count](node_t* node)
+            {
+                if(node->is_selected)
+                {
+                    count++;
+                }
+            }
+        );
+        return count;
+    }
+
+    int normalize_selected_nodes()
+    {
+        int count = 0;
+        node_table.iterate(
+            [&count](node_t* node)
+            {
+                if(node->is_selected)
+                {
+                    node->volume->normalize();
+                    count++;
+                }
+            }
+        );
+        return count;
+    }
+
+    void move_selected_nodes_by(int dx_tile, int dy_tile)
+    {
+        node_table.iterate(
+            [&table = node_table, dx_tile, dy_tile](std::unique_ptr<node_t>& node)
+            {
+                if(node->is_selected)
+                {
+                    int x_tile = node->x_tile + dx_tile;
+                    int y_tile = node->y_tile + dy_tile;
+                    if(node_t* exists = table.get(x_tile, y_tile))
+                    {
+                        return;
+                    }
+                    if(node->was_moved)
+                    {
+                        /* do not move again */
+                    }
+                    else
+                    {
+                        node->was_moved = true;
+                        table.move(node, x_tile, y_tile);
+                    }
+                }
+            }
+        );
+        node_table.iterate(
+            [](node_t* node)
+            {
+                node->was_moved = false;
+            }
+        );
+    }
+
+    void add_child_to_selected_nodes(node_t* child)
+    {
+        node_table.iterate(
+            [child](node_t* node)
+            {
+                if(node->is_selected)
+                {
+                    node->add_child(child);
+                }
+            }
+        );
+        compile_schedule();
+    }
+
+    int delete_selected_nodes()
+    {
+        int count = 0;
+        node_table.iterate(
+            [this, &count](std::unique_ptr<node_t>& node)
+            {
+                if(node.get() not_eq graph and node->is_selected)
+                {
+                    count++;
+                    node_table.delete_node(node);
+                }
+            }
+        );
+        compile_schedule();
+        return count;
+    }
+
+    void normalize_all_nodes()
+    {
+        node_table.iterate(
+            [](node_t* node)
+            {
+                node->volume->normalize();
+            }
+        );
+    }
+
+    /* prop edits write gas fields and dimensions behind the back of the gas mutators, and
+     * masses and dimensions behind the back of the drivetrain */
+
+    void invalidate_all_nodes()
+    {
+        drivetrain.invalidate();
+        node_table.iterate(
+            [](node_t* node)
+            {
+                node->volume->invalidate_composition();
+            }
+        );
+    }
+
+    void reset_all_nodes_work_time()
+    {
+        node_table.iterate(
+            [](node_t* node)
+            {
+                node->work_time_ns = 0.0;
+                node->port->work_time_ns = 0.0;
+            }
+        );
+    }
+
+    double calc_applied_torque_n_m()
+    {
+        return drivetrain.calc_applied_torque_n_m();
+    }
+
+    void set_detail_level(detail_level_t level)
+    {
+        detail_level = level;
+        detail_phase = 0;
+        cycle_torque_sum_n_m = 0.0; /* a part cycle would skew the mean */
+        cycle_torque_samples = 0;
+        audio_processor.decimation = level == detail_level_t::reduced ? sim_n::reduced_detail_decimation : 1;
+        audio_processor.is_convolution_enabled = level == detail_level_t::full;
+        audio_processor.is_synthesized = level == detail_level_t::minimal;
+    }
+
+    /* every flux is sized against the whole of its source, so a source with several out edges,
+     * like a plenum feeding its injectors, can be asked for more than it holds. the parcels of
+     * such a source are scaled down together before any is applied, so the apply phase never
+     * overdraws and a step is never left half applied */
+
+    void balance_fluxes()
+    {
+        for(const gas_flux_t& flux : fluxes)
+        {
+            if(flux.parcel)
+            {
+                flux_debit_moles[flux.source->index] = 0.0;
+            }
+        }
+        for(const gas_flux_t& flux : fluxes)
+        {
+            if(flux.parcel)
+            {
+                flux_debit_moles[flux.source->index] += flux.parcel->moles;
+            }
+        }
+        for(gas_flux_t& flux : fluxes)
+        {
+            if(flux.parcel)
+            {
+                double max_debit_moles = sim_n::max_flux_draw_ratio * flux.source->moles();
+                double debit_moles = flux_debit_moles[flux.source->index];
+                if(debit_moles > max_debit_moles)
+                {
+                    double ratio = max_debit_moles / debit_moles;
+                    flux.parcel->moles *= ratio;
+                    flux.parcel->bulk_momentum_kg_m_per_s *= ratio;
+                }
+            }
+        }
+    }
+
+    /* one pass over the graph, advancing the gas by dt_s */
+
+    void run_graph_once(double dt_s, bool is_new_rotation)
+    {
+        bool is_plotted = detail_level == detail_level_t::full;
+        schedule.execute(
+            [this, dt_s, is_new_rotation, is_plotted](node_t* parent)
+            {
+                parent->volume->do_work();
+                parent->volume->compress();
+                parent->volume->ignite(dt_s);
+                parent->volume->read_mail(cycle);
+                parent->port->open();
+                if(parent->is_selected and is_plotted)
+                {
+                    if(crankshaft.turned())
+                    {
+                        /* buffered after the step - the plot panel is shared across branches */
+                        parent->plot_datum = parent->volume->get_plot_datum();
+                        parent->plot_datum[panel_port_open_ratio] = parent->port->open_ratio;
+                        parent->plot_datum[panel_port_flow_velocity] = parent->port->flow_velocity_m_per_s.get();
+                    }
+                }
+                if(is_new_rotation)
+                {
+                    parent->volume->mol_balance = 0.0;
+                }
+                /* the flux phase only reads, so derived properties are settled here by their owner */
+                parent->volume->calc_derived_state();
+            },
+            [this, dt_s](int edge, node_t* parent, node_t* child, port_t* port)
+            {
+                /* convention defines port is always parent edge port regardless of flow direction */
+                /* todo: 1dcfd will remove this convention - each volume will have input and output port */
+                gas_flux_t& flux = fluxes[edge];
+                flux = {};
+                double delta_total_pressure_pa = parent->volume->calc_total_pressure_pa() - child->volume->calc_total_pressure_pa();
+                if(std::abs(delta_total_pressure_pa) > port->flow_threshold_pressure_pa)
+                {
+                    if(delta_total_pressure_pa > 0.0)
+                    {
+                        flux.source = parent->volume.get();
+                        flux.destination = child->volume.get();
+                    }
+                    else
+                    {
+                        flux.source = child->volume.get();
+                        flux.destination = parent->volume.get();
+                    }
+                    flux.parcel = flux.source->calc_mail(*flux.destination, *port, cycle, dt_s);
+                }
+            },
+            [this]()
+            {
+                balance_fluxes();
+            },
+            [this](int edge, node_t*, node_t*, port_t* port)
+            {
+                gas_flux_t& flux = fluxes[edge];
+                if(flux.parcel)
+                {
+                    flux.source->send_mail(*flux.destination, *port, *flux.parcel);
+                }
+                else
+                if(flux.source)
+                {
+                    port->flow_velocity_m_per_s.set(0.0);
+                }
+            }
+        );
+        if(is_plotted)
+        {
+            int channels = count_selected_nodes();
+            plot_panel.set_channels(channels);
+            if(crankshaft.turned())
+            {
+                int channel = 0;
+                for(node_t* node : schedule.nodes)
+                {
+                    if(node->is_selected)
+                    {
+                        plot_panel.buffer(channel++, crankshaft.theta_r, node->plot_datum);
+                    }
+                }
+            }
+            if(crankshaft.finished_rotation())
+            {
+                plot_panel.flip();
+            }
+        }
+    }
+
+    /* the crank always steps at the sample rate. full detail passes over the graph every
+     * step. reduced passes every few steps with a longer dt and interpolates the audio
+     * between passes. minimal leaves the gas as it was and drives the crank with the mean
+     * torque of the last simulated cycle */
+
+    void run_sim_once()
+    {
+        prop_graph.run_cycle();
+        for(node_t* node : prop_graph.cycle_nodes)
+        {
+            /* live props write gas fields and dimensions behind the back of the gas mutators */
+            node->volume->invalidate_composition();
+        }
+        if(drivetrain.is_live)
+        {
+            drivetrain.invalidate();
+        }
+        throttle_cable.apply();
+        double moment_of_inertia_kg_per_m2 = drivetrain.calc_moment_of_inertia_kg_per_m2();
+        double applied_torque_n_m = 0.0;
+        double friction_torque_n_m = 0.0;
+        double starter_torque_n_m = starter_motor.calc_applied_torque_n_m();
+        if(detail_level == detail_level_t::minimal)
+        {
+            applied_torque_n_m = cycle_mean_torque_n_m + starter_torque_n_m;
+            friction_torque_n_m = drivetrain.calc_friction_torque_n_m();
+        }
+        else
+        {
+            drivetrain.calc_torques_n_m(applied_torque_n_m, friction_torque_n_m);
+            cycle_torque_sum_n_m += applied_torque_n_m - starter_torque_n_m;
+            cycle_torque_samples++;
+        }
+        double torque_n_m = applied_torque_n_m - friction_torque_n_m;
+        double angular_acceleration_r_per_s = torque_n_m / moment_of_inertia_kg_per_m2;
+        if(held_angular_velocity_r_per_s)
+        {
+            crankshaft.angular_velocity_r_per_s = *held_angular_velocity_r_per_s;
+            angular_acceleration_r_per_s = 0.0;
+        }
+        crankshaft.accelerate(angular_acceleration_r_per_s, sim_n::dt_s);
+        if(detail_level == detail_level_t::minimal and crankshaft.angular_velocity_r_per_s < 0.0)
+        {
+            /* there is no gas to stall against, so the held torque could otherwise spin the crank backwards */
+            crankshaft.angular_velocity_r_per_s = 0.0;
+        }
+        has_finished_rotation = has_finished_rotation or crankshaft.finished_rotation();
+        if(detail_level == detail_level_t::full)
+        {
+            run_graph_once(sim_n::dt_s, has_finished_rotation);
+            has_finished_rotation = false;
+        }
+        else
+        if(detail_level == detail_level_t::reduced)
+        {
+            if(detail_phase == 0)
+            {
+                run_graph_once(sim_n::reduced_detail_decimation * sim_n::dt_s, has_finished_rotation);
+                has_finished_rotation = false;
+            }
+            if(crankshaft.turned())
+            {
+                audio_processor.upsample(detail_phase);
+            }
+            detail_phase = (detail_phase + 1) % sim_n::reduced_detail_decimation;
+        }
+        else
+        if(crankshaft.turned())
+        {
+            audio_processor.synthesize();
+        }
+        if(crankshaft.finished_rotation() and detail_level not_eq detail_level_t::minimal and cycle_torque_samples > 0)
+        {
+            /* smoothed over a few cycles, so one misfire or rev limited cycle does not set the torque for good */
+            double mean_torque_n_m = cycle_torque_sum_n_m / cycle_torque_samples;
+            cycle_mean_torque_n_m += sim_n::minimal_detail_torque_smoothing * (mean_torque_n_m - cycle_mean_torque_n_m);
+            cycle_torque_sum_n_m = 0.0;
+            cycle_torque_samples = 0;
+        }
+        cycle++;
+    }
+};
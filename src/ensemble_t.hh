@@ -0,0 +1,245 @@
+/* ensim3 --ensemble [file] --vary key=from:to:count [--vary key=from:to:count ...] [--seconds s]
+ *                   [--measure-seconds s] [--throttle ratio] [--threads n] [--out report.csv|report.json|-]
+ *
+ * runs one engine as an ensemble of lanes, one lane per combination of varied props - for
+ * tolerance studies of port diameters, cam and spark timing and the like. a varied prop is
+ * set on every node that carries it, or once when it is engine wide. variants of one engine
+ * branch apart at every port that opens a step earlier or flame that lights a step later, so
+ * lanes do not share control flow - each lane runs as its own engine and lanes are spread
+ * across a pool of threads. the report holds each lane's props, exactly as they were set, and
+ * its crank speed, torque, peak cylinder pressure and wideband air fuel ratio, averaged over
+ * the last measure seconds of the run */
+
+struct ensemble_variant_t
+{
+    std::string key = "";
+    std::vector<double> values;
+};
+
+struct ensemble_lane_t
+{
+    std::vector<double> values; /* one per variant */
+    double angular_velocity_r_per_s = 0.0;
+    double torque_n_m = 0.0;
+    double peak_pressure_pa = 0.0;
+    double air_fuel_mass_ratio = 0.0;
+    int faults = 0;
+};
+
+struct ensemble_t
+{
+    std::string filename = "engines/test.ensim3";
+    std::vector<ensemble_variant_t> variants;
+    double seconds = 5.0;
+    double measure_seconds = 1.0;
+    std::optional<double> throttle;
+    batch_t batch;
+
+    ensemble_t(const std::vector<std::string>& args)
+    {
+        int size = args.size();
+        for(int i = 0; i < size; i++)
+        {
+            const std::string& arg = args[i];
+            bool has_value = i + 1 < size;
+            if(arg == "--ensemble")
+            {
+                if(has_value and args[i + 1].starts_with("--") == false)
+                {
+                    filename = args[++i];
+                }
+            }
+            else
+            if(arg == "--vary" and has_value)
+            {
+                variants.push_back(parse_variant(args[++i]));
+            }
+            else
+            if(arg == "--seconds" and has_value)
+            {
+                seconds = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--measure-seconds" and has_value)
+            {
+                measure_seconds = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--throttle" and has_value)
+            {
+                throttle = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--threads" and has_value)
+            {
+                batch.thread_count = std::max(1, std::stoi(args[++i]));
+            }
+            else
+            if(arg == "--out" and has_value)
+            {
+                batch.out_filename = args[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("unknown or incomplete argument: " + arg);
+            }
+        }
+        if(variants.empty())
+        {
+            throw std::invalid_argument("an ensemble needs at least one --vary key=from:to:count");
+        }
+    }
+
+    static ensemble_variant_t parse_variant(const std::string& variant)
+    {
+        size_t pos = variant.find('=');
+        if(pos == std::string::npos)
+        {
+            throw std::invalid_argument("expected key=from:to:count, got: " + variant);
+        }
+        return {variant.substr(0, pos), dyno_t::parse_range(variant.substr(pos + 1))};
+    }
+
+    /* every combination of variant values, the last variant changing fastest */
+
+    std::vector<ensemble_lane_t> make_lanes() const
+    {
+        std::vector<ensemble_lane_t> lanes = {{}};
+        for(const ensemble_variant_t& variant : variants)
+        {
+            std::vector<ensemble_lane_t> next_lanes;
+            for(const ensemble_lane_t& lane : lanes)
+            {
+                for(double value : variant.values)
+                {
+                    ensemble_lane_t& next_lane = next_lanes.emplace_back(lane);
+                    next_lane.values.push_back(value);
+                }
+            }
+            lanes = std::move(next_lanes);
+        }
+        return lanes;
+    }
+
+    /* an engine wide prop is committed once, a node's prop on every node that carries it */
+
+    void vary(engine_t& engine, const ensemble_variant_t& variant, double value) const
+    {
+        std::string value_string = double_to_exact_string(value);
+        if(engine.global_prop_table.get(variant.key))
+        {
+            engine.commit_prop(engine.graph, variant.key, value_string);
+            return;
+        }
+        int count = 0;
+        engine.node_table.iterate(
+            [&](node_t* node)
+            {
+                if(engine.make_local_prop_table(node).get(variant.key))
+                {
+                    engine.commit_prop(node, variant.key, value_string);
+                    count++;
+                }
+            }
+        );
+        if(count == 0)
+        {
+            throw std::invalid_argument("no node has a prop named " + variant.key);
+        }
+    }
+
+    ensemble_lane_t simulate(ensemble_lane_t lane) const
+    {
+        engine_t engine;
+        batch_t::load_engine(engine, filename);
+        int size = variants.size();
+        for(int index = 0; index < size; index++)
+        {
+            vary(engine, variants[index], lane.values[index]);
+        }
+        /* resized volumes would otherwise start over or under pressure */
+        engine.normalize_all_nodes();
+        if(throttle)
+        {
+            engine.throttle_cable.pull_ratio_setpoint = *throttle;
+        }
+        int cycles = seconds * sim_n::sample_frequency_hz;
+        int measure_from_cycle = cycles - std::clamp(measure_seconds, 0.0, seconds) * sim_n::sample_frequency_hz;
+        int samples = 0;
+        int piston_count = std::max(1, static_cast<int>(engine.pistons.size()));
+        for(int cycle = 0; cycle < cycles; cycle++)
+        {
+            batch_t::step(engine, lane.faults);
+            if(cycle < measure_from_cycle)
+            {
+                continue;
+            }
+            double air_fuel_mass_ratio = 0.0;
+            for(piston_t* piston : engine.pistons)
+            {
+                lane.peak_pressure_pa = std::max(lane.peak_pressure_pa, piston->calc_static_pressure_pa());
+                air_fuel_mass_ratio += piston->calc_equivalent_air_fuel_mass_ratio();
+            }
+            lane.angular_velocity_r_per_s += engine.crankshaft.angular_velocity_r_per_s;
+            lane.torque_n_m += engine.calc_applied_torque_n_m();
+            lane.air_fuel_mass_ratio += air_fuel_mass_ratio / piston_count;
+            samples++;
+        }
+        if(samples > 0)
+        {
+            lane.angular_velocity_r_per_s /= samples;
+            lane.torque_n_m /= samples;
+            lane.air_fuel_mass_ratio /= samples;
+        }
+        return lane;
+    }
+
+    batch_report_t make_report(const std::vector<ensemble_lane_t>& lanes) const
+    {
+        batch_report_t report;
+        report.columns.push_back("lane");
+        for(const ensemble_variant_t& variant : variants)
+        {
+            report.columns.push_back(variant.key);
+        }
+        report.columns.insert(report.columns.end(), {"angular_velocity_r_per_s", "rpm", "torque_n_m", "peak_pressure_pa", "air_fuel_mass_ratio", "faults"});
+        int size = lanes.size();
+        for(int index = 0; index < size; index++)
+        {
+            const ensemble_lane_t& lane = lanes[index];
+            std::vector<std::string>& row = report.rows.emplace_back();
+            row.push_back(std::to_string(index));
+            for(double value : lane.values)
+            {
+                row.push_back(double_to_exact_string(value));
+            }
+            row.insert(row.end(), {
+                double_to_string(lane.angular_velocity_r_per_s, 4),
+                double_to_string(lane.angular_velocity_r_per_s * 60.0 / (2.0 * M_PI), 1),
+                double_to_string(lane.torque_n_m, 6),
+                double_to_string(lane.peak_pressure_pa, 1),
+                double_to_string(lane.air_fuel_mass_ratio, 6),
+                std::to_string(lane.faults),
+            });
+        }
+        return report;
+    }
+
+    int run()
+    {
+        std::vector<ensemble_lane_t> lanes = make_lanes();
+        double wall_time_s = batch.run(
+            lanes, "simulated", "lanes",
+            [this](const ensemble_lane_t& lane)
+            {
+                return simulate(lane);
+            }
+        );
+        batch.write(make_report(lanes));
+        std::cerr
+            << "simulated " << lanes.size() << " lanes of " << filename
+            << " for " << double_to_string(seconds, 2) << " s"
+            << " on " << batch.thread_count << " thread(s) in " << double_to_string(wall_time_s, 2) << " s\n";
+        return 0;
+    }
+};
@@ -2,78 +2,89 @@ struct ensim_t
 {
     std::string filename = "engines/test.ensim3";
     std::string command_message = "";
-    int cycle = 0;
     int cycles_per_frame = sim_n::cycles_per_frame;
     bool is_slowmo_mode = false;
-    bool is_done = false;
-    int x_tiles = 38;
-    int y_tiles = 20;
+    std::atomic<bool> is_done = false;
+    double sim_time_ms = 0.0;
+    std::mutex engine_mutex; /* held by the simulation thread while stepping and by the ui thread while editing or drawing the engine */
+    bool is_execution_flow_demo_requested = false; /* played after input is handled, as it sleeps between frames */
+    std::thread sim_thread;
     int plot_panel_tiles = 7;
-    sdl_t sdl{tile_to_pixel_p(x_tiles), tile_to_pixel_p(y_tiles)};
-    plot_panel_t plot_panel{tile_to_pixel_p(x_tiles - plot_panel_tiles), sdl.yres_p, tile_to_pixel_p(plot_panel_tiles)};
-    crankshaft_t crankshaft;
-    camshaft_t camshaft{crankshaft};
-    audio_processor_t audio_processor{crankshaft}; /* todo: collect audio from multiple collectors (like dual exhaust) */
-    flywheel_t flywheel;
-    starter_motor_t starter_motor{crankshaft, flywheel};
-    throttle_cable_t throttle_cable;
-    std::vector<piston_t*> pistons;
-    std::vector<injector_t*> injectors;
-    std::vector<rotational_mass_t*> rotational_masses = {&crankshaft, &camshaft, &flywheel, &starter_motor};
-    std::vector<throttle_port_t*> throttle_ports;
-    node_table_t node_table{x_tiles, y_tiles, pistons, injectors, rotational_masses, throttle_ports};
-    node_t* graph = nullptr;
+    engine_t engine;
+    sdl_t sdl{tile_to_pixel_p(engine.x_tiles), tile_to_pixel_p(engine.y_tiles)};
     node_t* select = nullptr;
+    prop_table_t selected_prop_table;
+    node_t* selected_prop_node = nullptr;
+    int selected_prop_revision = 0;
+    input_log_t input_log;
 
-    ensim_t()
+    ensim_t(const std::vector<std::string>& args)
     {
+        int size = args.size();
+        for(int i = 0; i < size; i++)
+        {
+            if(args[i] == "--record" and i + 1 < size)
+            {
+                input_log.open(args[++i]);
+            }
+        }
+        engine.plot_panel.layout(tile_to_pixel_p(engine.x_tiles - plot_panel_tiles), sdl.yres_p, tile_to_pixel_p(plot_panel_tiles));
         sdl.play_audio();
         setup_input_handlers();
-        int x_tile = x_tiles - 8;
-        int y_tile = y_tiles / 2;
-        std::unique_ptr<node_t> source = make_node(x_tile, y_tile, "source");
-        graph = source.get();
-        select = graph;
-        node_table.create_node(x_tile, y_tile, std::move(source));
+        int x_tile = engine.x_tiles - 8;
+        int y_tile = engine.y_tiles / 2;
+        std::unique_ptr<node_t> source = engine.make_node(x_tile, y_tile, "source");
+        engine.graph = source.get();
+        select = engine.graph;
+        engine.node_table.create_node(x_tile, y_tile, std::move(source));
         load_nodes_from_disk();
     }
 
-    void move_selected_nodes_to(int dx_tile, int dy_tile)
+    /* every input that changes the engine is stamped, logged, and applied the way a replay applies it */
+
+    void apply_input(input_t input)
     {
-        node_table.iterate(
-            [&table = node_table, dx_tile, dy_tile](std::unique_ptr<node_t>& node)
+        input.cycle = engine.cycle;
+        input_log.record(input);
+        input_log_t::apply(engine, input);
+    }
+
+    std::vector<tile_t> get_selected_tiles()
+    {
+        std::vector<tile_t> tiles;
+        engine.node_table.iterate(
+            [&tiles](node_t* node)
             {
                 if(node->is_selected)
                 {
-                    int x_tile = node->x_tile + dx_tile;
-                    int y_tile = node->y_tile + dy_tile;
-                    if(node_t* exists = table.get(x_tile, y_tile))
-                    {
-                        return;
-                    }
-                    if(node->was_moved)
-                    {
-                        /* do not move again */
-                    }
-                    else
-                    {
-                        node->was_moved = true;
-                        table.move(node, x_tile, y_tile);
-                    }
+                    tiles.push_back({node->x_tile, node->y_tile});
                 }
             }
         );
-        node_table.iterate(
-            [](node_t* node)
-            {
-                node->was_moved = false;
-            }
-        );
+        return tiles;
+    }
+
+    void load_nodes_from_disk()
+    {
+        apply_input({0, "load", 0, 0, {}, filename});
+        if(engine.graph)
+        {
+            command_message = "loaded " + filename;
+        }
+        select = engine.graph;
+    }
+
+    void move_selected_nodes_to(int dx_tile, int dy_tile)
+    {
+        if(dx_tile not_eq 0 or dy_tile not_eq 0)
+        {
+            apply_input({0, "move", dx_tile, dy_tile, get_selected_tiles(), ""});
+        }
     }
 
     void select_all_nodes()
     {
-        node_table.iterate(
+        engine.node_table.iterate(
             [](node_t* node)
             {
                 node->is_selected = true;
@@ -83,7 +94,7 @@ struct ensim_t
 
     void deselect_all_nodes()
     {
-        node_table.iterate(
+        engine.node_table.iterate(
             [](node_t* node)
             {
                 node->is_selected = false;
@@ -94,7 +105,7 @@ struct ensim_t
 
     node_t* select_node_at(int x_tile, int y_tile)
     {
-        if(node_t* exists = node_table.get(x_tile, y_tile))
+        if(node_t* exists = engine.node_table.get(x_tile, y_tile))
         {
             exists->is_selected = true;
             return exists;
@@ -104,7 +115,7 @@ struct ensim_t
 
     void select_nodes_in(const render_rect_t& render_rect)
     {
-        node_table.iterate(
+        engine.node_table.iterate(
             [&render_rect](node_t* node)
             {
                 int x_p = tile_to_pixel_p(node->x_tile);
@@ -117,26 +128,32 @@ struct ensim_t
         );
     }
 
+    /* the shown table is made once per selection and kept while the engine's props stay put,
+     * so its text is only formatted as values move and survives being typed over */
+
     prop_table_t* get_selected_prop_table()
     {
-        if(select)
+        if(select == nullptr)
         {
-            return &select->prop_table;
+            return nullptr;
         }
-        return nullptr;
+        if(select not_eq selected_prop_node or engine.prop_revision not_eq selected_prop_revision)
+        {
+            selected_prop_table = engine.make_prop_table(select);
+            selected_prop_node = select;
+            selected_prop_revision = engine.prop_revision;
+        }
+        return &selected_prop_table;
     }
 
     void add_child_to_selected(node_t* child)
     {
-        node_table.iterate(
-            [child](node_t* node)
-            {
-                if(node->is_selected)
-                {
-                    node->add_child(child);
-                }
-            }
-        );
+        apply_input({0, "join", child->x_tile, child->y_tile, get_selected_tiles(), ""});
+    }
+
+    void set_throttle(double pull_ratio_setpoint)
+    {
+        apply_input({0, "throttle", 0, 0, {}, double_to_exact_string(pull_ratio_setpoint)});
     }
 
     void selected_prop_table_operate(std::function<void(prop_table_t*)> operate)
@@ -149,106 +166,6 @@ struct ensim_t
         }
     }
 
-    void save_nodes_to_disk()
-    {
-        int uid = 0;
-        std::unordered_map<node_t*, int> node_to_uid;
-        std::ofstream file{filename};
-        if(file.is_open())
-        {
-            graph->iterate(
-                [&file, &uid, &node_to_uid](node_t* parent)
-                {
-                    file
-                        << "make" << ":"
-                        << std::to_string(uid) << ":"
-                        << std::to_string(parent->x_tile) << ":"
-                        << std::to_string(parent->y_tile) << ":"
-                        << parent->volume->name << ":";
-                    for(const prop_t& prop : parent->prop_table.table)
-                    {
-                        file << prop.key << "=" << prop.value << ",";
-                    }
-                    file << "\n";
-                    node_to_uid[parent] = uid++;
-                    return false;
-                });
-            graph->iterate(
-                [&file, &node_to_uid](node_t* parent, node_t* child)
-                {
-                    file
-                        << "join" << ":"
-                        << std::to_string(node_to_uid[parent]) << ":"
-                        << std::to_string(node_to_uid[child]) << "\n";
-                    return false;
-                });
-            file.close();
-            command_message = "saved to " + filename;
-        }
-    }
-
-    void unpack_props(const std::string& props, node_t* node)
-    {
-        std::string pair = "";
-        std::stringstream stream{props};
-        while(std::getline(stream, pair, ','))
-        {
-            size_t pos = pair.find('=');
-            if(pos not_eq std::string::npos)
-            {
-                std::string key = pair.substr(0, pos);
-                std::string value = pair.substr(pos + 1);
-                node->prop_table.set_prop(key, value);
-            }
-        }
-    }
-
-    void load_nodes_from_disk()
-    {
-        node_table.clear();
-        std::unordered_map<int, node_t*> uid_to_node;
-        std::ifstream file{filename};
-        if(file.is_open())
-        {
-            std::string line = "";
-            while(std::getline(file, line))
-            {
-                std::vector<std::string> tokens;
-                std::stringstream stream{line};
-                std::string token = "";
-                while(std::getline(stream, token, ':'))
-                {
-                    tokens.push_back(token);
-                }
-                const std::string& command = tokens[0];
-                if(command == "make")
-                {
-                    int uid = std::stoi(tokens[1]);
-                    int x_tile = std::stoi(tokens[2]);
-                    int y_tile = std::stoi(tokens[3]);
-                    const std::string& name = tokens[4];
-                    const std::string& props = tokens[5];
-                    std::unique_ptr<node_t> node = make_node(x_tile, y_tile, name);
-                    unpack_props(props, node.get());
-                    uid_to_node[uid] = node.get();
-                    node_table.create_node(x_tile, y_tile, std::move(node));
-                }
-                else
-                if(command == "join")
-                {
-                    int parent_uid = std::stoi(tokens[1]);
-                    int child_uid = std::stoi(tokens[2]);
-                    node_t* parent = uid_to_node[parent_uid];
-                    node_t* child = uid_to_node[child_uid];
-                    parent->add_child(child);
-                }
-            }
-            command_message = "loaded " + filename;
-        }
-        graph = uid_to_node[0];
-        select = graph;
-    }
-
     void setup_input_handlers()
     {
         sdl.on_exit =
@@ -264,7 +181,7 @@ struct ensim_t
             {
                 int x_tile = pixel_to_tile(x_p);
                 int y_tile = pixel_to_tile(y_p);
-                if(node_table.in_bounds(x_tile, y_tile))
+                if(engine.node_table.in_bounds(x_tile, y_tile))
                 {
                     node_t* node = select;
                     if(node)
@@ -312,7 +229,7 @@ struct ensim_t
             {
                 int x_tile = pixel_to_tile(x_p);
                 int y_tile = pixel_to_tile(y_p);
-                node_t* child = node_table.get(x_tile, y_tile);
+                node_t* child = engine.node_table.get(x_tile, y_tile);
                 if(child)
                 {
                     add_child_to_selected(child);
@@ -320,9 +237,8 @@ struct ensim_t
                 else
                 {
                     deselect_all_nodes();
-                    std::unique_ptr<node_t> node = make_node(x_tile, y_tile, "volume");
-                    node->is_selected = true;
-                    node_table.create_node(x_tile, y_tile, std::move(node));
+                    apply_input({0, "make", x_tile, y_tile, {}, "volume"});
+                    select_node_at(x_tile, y_tile);
                 }
             };
 
@@ -342,25 +258,25 @@ struct ensim_t
         sdl.edit_on_1_key_down =
             [this]()
             {
-                throttle_cable.pull_ratio_setpoint = 0.10;
+                set_throttle(0.10);
             };
 
         sdl.edit_on_2_key_down =
             [this]()
             {
-                throttle_cable.pull_ratio_setpoint = 0.33;
+                set_throttle(0.33);
             };
 
         sdl.edit_on_3_key_down =
             [this]()
             {
-                throttle_cable.pull_ratio_setpoint = 0.66;
+                set_throttle(0.66);
             };
 
         sdl.edit_on_4_key_down =
             [this]()
             {
-                throttle_cable.pull_ratio_setpoint = 0.99;
+                set_throttle(0.99);
             };
 
         sdl.edit_on_ctrl_a_key_down =
@@ -372,7 +288,10 @@ struct ensim_t
         sdl.edit_on_ctrl_s_key_down =
             [this]()
             {
-                save_nodes_to_disk();
+                if(engine.save_nodes_to_disk(filename))
+                {
+                    command_message = "saved to " + filename;
+                }
             };
 
         sdl.edit_on_ctrl_l_key_down =
@@ -406,7 +325,7 @@ struct ensim_t
             {
                 if(select)
                 {
-                    graph = select;
+                    apply_input({0, "root", select->x_tile, select->y_tile, {}, ""});
                 }
             };
 
@@ -456,7 +375,8 @@ struct ensim_t
         sdl.edit_on_n_key_down =
             [this]()
             {
-                int count = normalize_selected_nodes();
+                int count = engine.count_selected_nodes();
+                apply_input({0, "normalize", 0, 0, get_selected_tiles(), ""});
                 command_message = "normalized " + double_to_string(count, 0) + " node(s)";
             };
 
@@ -506,10 +426,18 @@ struct ensim_t
         sdl.edit_on_q_key_down =
             [this]()
             {
-                draw_execution_flow_demo();
+                is_execution_flow_demo_requested = true;
                 command_message = "drew execution flow";
             };
 
+        sdl.edit_on_t_key_down =
+            [this]()
+            {
+                engine.schedule.cycle_profile_mode();
+                sdl.is_profiling = engine.schedule.is_profiling();
+                command_message = "profiling " + engine.schedule.get_profile_mode_name();
+            };
+
         sdl.edit_on_delete_key_down =
             [this]()
             {
@@ -562,27 +490,12 @@ struct ensim_t
                         {
                             if(select)
                             {
-                                int x_tile = select->x_tile;
-                                int y_tile = select->y_tile;
-                                const std::string& name = prop->value;
-                                node_table.polymorph(select, make_node(x_tile, y_tile, name));
+                                apply_input({0, "polymorph", select->x_tile, select->y_tile, {}, prop->value});
                             }
                         }
                         else
                         {
-                            prop->commit(
-                                [prop_table](const std::string& key)
-                                {
-                                    if(std::optional<prop_t::real_t> real = prop_table->find(key))
-                                    {
-                                        if(std::holds_alternative<double*>(*real))
-                                        {
-                                            return *std::get<double*>(*real);
-                                        }
-                                    }
-                                    return 0.0;
-                                }
-                            );
+                            apply_input({0, "commit", select->x_tile, select->y_tile, {}, std::string{prop->key} + "=" + prop->value});
                         }
                         sdl.is_append_mode = false;
                     }
@@ -601,276 +514,80 @@ struct ensim_t
             };
     }
 
-    std::unique_ptr<node_t> make_node(int x_tile, int y_tile, const std::string& name)
+    int delete_selected_nodes()
     {
-        std::unique_ptr<volume_t> volume;
-        std::unique_ptr<port_t> port;
-        if(name == "source")
-        {
-            volume = std::make_unique<source_t>();
-            port = std::make_unique<port_t>();
-        }
-        else
-        if(name == "throttle")
-        {
-            volume = std::make_unique<throttle_t>(pistons, injectors, crankshaft);
-            port = std::make_unique<throttle_port_t>(throttle_cable);
-        }
-        else
-        if(name == "plenum")
-        {
-            volume = std::make_unique<plenum_t>();
-            port = std::make_unique<port_t>();
-        }
-        else
-        if(name == "injector")
-        {
-            volume = std::make_unique<injector_t>(throttle_cable);
-            port = std::make_unique<actuated_port_t>(camshaft, 0.0 * M_PI, M_PI);
-        }
-        else
-        if(name == "piston")
-        {
-            volume = std::make_unique<piston_t>(camshaft);
-            port = std::make_unique<actuated_port_t>(camshaft, 3.0 * M_PI, M_PI);
-        }
-        else
-        if(name == "collector")
-        {
-            volume = std::make_unique<collector_t>(audio_processor, crankshaft);
-            port = std::make_unique<port_t>();
-        }
-        else
-        if(name == "exhaust")
-        {
-            volume = std::make_unique<exhaust_t>();
-            port = std::make_unique<port_t>();
-        }
-        else
-        if(name == "sink")
+        int count = engine.count_selected_nodes() - (engine.graph->is_selected ? 1 : 0);
+        if(select not_eq engine.graph)
         {
-            volume = std::make_unique<sink_t>();
-            port = std::make_unique<port_t>();
+            select = nullptr;
         }
-        else
-        {
-            volume = std::make_unique<volume_t>();
-            port = std::make_unique<port_t>();
-        }
-        std::unique_ptr<node_t> node = std::make_unique<node_t>(x_tile, y_tile, std::move(volume), std::move(port));
-        node->prop_table
-            = node->prop_table
-            + crankshaft.get_prop_table()
-            + camshaft.get_prop_table()
-            + flywheel.get_prop_table()
-            + throttle_cable.get_prop_table()
-            + starter_motor.get_prop_table();
-        return node;
-    }
-
-    int count_selected_nodes()
-    {
-        int count = 0;
-        node_table.iterate(
-            [&count](node_t* node)
-            {
-                if(node->is_selected)
-                {
-                    count++;
-                }
-            }
-        );
+        apply_input({0, "delete", 0, 0, get_selected_tiles(), ""});
         return count;
     }
 
-    int delete_selected_nodes()
-    {
-        int count = 0;
-        node_table.iterate(
-            [this, &count](std::unique_ptr<node_t>& node)
-            {
-                if(node.get() not_eq graph)
-                {
-                    if(node.get() == select)
-                    {
-                        select = nullptr;
-                    }
-                    if(node->is_selected)
-                    {
-                        count++;
-                        node_table.delete_node(node);
-                    }
-                }
-            }
-        );
-        return count;
-    }
-
-    int normalize_selected_nodes()
-    {
-        int count = 0;
-        node_table.iterate(
-            [&count](node_t* node)
-            {
-                if(node->is_selected)
-                {
-                    node->volume->normalize();
-                    count++;
-                }
-            }
-        );
-        return count;
-    }
-
-    void normalize_all_nodes()
-    {
-        node_table.iterate(
-            [](node_t* node)
-            {
-                node->volume->normalize();
-            }
-        );
-    }
-
-    void sync_all_nodes()
+    void run_sim()
     {
-        node_table.iterate(
-            [](node_t* node)
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < cycles_per_frame; i++)
+        {
+            try
             {
-                node->prop_table.sync();
+                engine.run_sim_once();
             }
-        );
-    }
-
-    void reset_all_nodes_work_time()
-    {
-        node_table.iterate(
-            [](node_t* node)
+            catch(const std::exception& exception)
             {
-                node->work_time_ns = 0.0;
-                node->port->work_time_ns = 0.0;
+                engine.normalize_all_nodes();
+                command_message = exception.what();
             }
-        );
-    }
-
-    double calc_moment_of_inertia_kg_per_m2()
-    {
-        double moment_of_inertia_kg_per_m2 = 0.0;
-        for(rotational_mass_t* mass : rotational_masses)
-        {
-            moment_of_inertia_kg_per_m2 += mass->calc_moment_of_inertia_kg_per_m2();
         }
-        return moment_of_inertia_kg_per_m2;
-    }
-
-    double calc_applied_torque_n_m()
-    {
-        double applied_torque_n_m = 0.0;
-        for(rotational_mass_t* mass : rotational_masses)
+        if(is_slowmo_mode == false)
         {
-            applied_torque_n_m += mass->calc_applied_torque_n_m();
+            sdl.queue_audio(engine.audio_processor.buffer);
         }
-        return applied_torque_n_m;
+        engine.audio_processor.buffer.clear();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        sim_time_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e6;
     }
 
-    double calc_friction_torque_n_m()
-    {
-        double friction_torque_n_m = 0.0;
-        for(rotational_mass_t* mass : rotational_masses)
-        {
-            friction_torque_n_m += mass->calc_friction_torque_n_m();
-        }
-        return friction_torque_n_m;
-    }
+    /* the simulation is paced by how full the audio ring is, not by the wall clock,
+     * so a slow ui frame only delays drawing and never the audio device */
 
-    void run_sim_once()
+    void run_sim_thread()
     {
-        throttle_cable.apply();
-        double moment_of_inertia_kg_per_m2 = calc_moment_of_inertia_kg_per_m2();
-        double applied_torque_n_m = calc_applied_torque_n_m();
-        double friction_torque_n_m = calc_friction_torque_n_m();
-        double torque_n_m = applied_torque_n_m - friction_torque_n_m;
-        double angular_acceleration_r_per_s = torque_n_m / moment_of_inertia_kg_per_m2;
-        crankshaft.accelerate(angular_acceleration_r_per_s);
-        int channels = count_selected_nodes();
-        plot_panel.set_channels(channels);
-        int channel = 0;
-        graph->iterate(
-            [this, &channel](node_t* parent)
-            {
-                parent->volume->do_work();
-                parent->volume->compress();
-                parent->volume->ignite();
-                parent->volume->read_mail(cycle);
-                parent->port->open();
-                if(parent->is_selected)
-                {
-                    if(crankshaft.turned())
-                    {
-                        std::vector<double> datum = parent->volume->get_plot_datum();
-                        datum[panel_port_open_ratio] = parent->port->open_ratio;
-                        datum[panel_port_flow_velocity] = parent->port->flow_velocity_m_per_s.get();
-                        plot_panel.buffer(channel++, crankshaft.theta_r, datum);
-                    }
-                }
-                if(crankshaft.finished_rotation())
-                {
-                    parent->volume->mol_balance = 0.0;
-                }
-                return false;
-            },
-            [this](node_t* parent, node_t* child)
-            {
-                /* convention defines port is always parent edge port regardless of flow direction */
-                /* todo: 1dcfd will remove this convention - each volume will have input and output port */
-                parent->volume->port = parent->port.get();
-                child->volume->port = parent->port.get();
-                double delta_total_pressure_pa = parent->volume->calc_total_pressure_pa() - child->volume->calc_total_pressure_pa();
-                if(std::abs(delta_total_pressure_pa) > parent->port->flow_threshold_pressure_pa)
+        int audio_queue_setpoint = sim_n::audio_queue_setpoint_frames * sim_n::cycles_per_frame;
+        while(not is_done)
+        {
+            double delay_ms = 1.0;
+            {
+                std::lock_guard<std::mutex> lock{engine_mutex};
+                if(sdl.is_pause_mode == false)
                 {
-                    if(delta_total_pressure_pa > 0.0)
+                    if(is_slowmo_mode)
                     {
-                        parent->volume->send_mail(*child->volume.get(), cycle);
+                        run_sim();
+                        delay_ms = sim_n::frame_time_ms;
                     }
                     else
+                    if(sdl.get_audio_queue_size() < audio_queue_setpoint)
                     {
-                        child->volume->send_mail(*parent->volume.get(), cycle);
+                        run_sim();
+                        delay_ms = 0.0;
                     }
                 }
-                return false;
             }
-        );
-        if(crankshaft.finished_rotation())
-        {
-            plot_panel.flip();
+            sdl.delay(delay_ms);
         }
-        cycle++;
     }
 
-    void run_sim()
-    {
-        for(int i = 0; i < cycles_per_frame; i++)
-        {
-            try
-            {
-                run_sim_once();
-            }
-            catch(const std::exception& exception)
-            {
-                normalize_all_nodes();
-                command_message = exception.what();
-            }
-        }
-        if(is_slowmo_mode == false)
-        {
-            sdl.queue_audio(audio_processor.buffer);
-        }
-        audio_processor.buffer.clear();
-    }
+    /* the simulation thread does not touch the engine while paused, so the graph is walked
+     * and the frames slept on without holding the engine lock */
 
     void draw_execution_flow_demo()
     {
-        sdl.is_pause_mode = true;
+        {
+            std::lock_guard<std::mutex> lock{engine_mutex};
+            sdl.is_pause_mode = true;
+        }
         int frame_time_s = 200;
         sdl.lock();
         sdl.clear();
@@ -878,7 +595,7 @@ struct ensim_t
         sdl.unlock();
         sdl.flip();
         sdl.delay(frame_time_s);
-        graph->iterate(
+        engine.graph->iterate(
             [this, frame_time_s](node_t* parent)
             {
                 sdl.lock();
@@ -899,6 +616,7 @@ struct ensim_t
         );
         int watch_time_s = 3 * frame_time_s;
         sdl.delay(watch_time_s);
+        std::lock_guard<std::mutex> lock{engine_mutex};
         sdl.is_pause_mode = false;
     }
 
@@ -912,14 +630,13 @@ struct ensim_t
         sdl.flip();
     }
 
-    void render_ui(double frame_time_ms, double sim_time_ms)
+    /* everything drawn from the engine - drawn into the texture under the engine lock, which
+     * leaves the texture holding the frame's copy of the engine */
+
+    void render_engine()
     {
-        int x_margin_p = tile_to_pixel_p(0.5); /* todo: top level DSL for GUI coords in ui_n */
-        int y_margin_p = tile_to_pixel_p(0.5);
-        sdl.lock();
-        sdl.clear();
-        sdl.draw_grid();
-        node_table.iterate(
+        std::lock_guard<std::mutex> lock{engine_mutex};
+        engine.node_table.iterate(
             [this](node_t* parent)
             {
                 sdl.draw_node(parent, parent->is_selected ? colo_t::white : colo_t::blue);
@@ -932,6 +649,11 @@ struct ensim_t
         selected_prop_table_operate(
             [this](prop_table_t* prop_table)
             {
+                /* only the drawn table is synced, and never over text being typed */
+                if(sdl.is_append_mode == false)
+                {
+                    prop_table->sync();
+                }
                 sdl.draw_properties(tile_to_pixel_p(0.5), tile_to_pixel_p(1.5), prop_table);
             }
         );
@@ -939,13 +661,29 @@ struct ensim_t
         {
             sdl.draw_node(select, select->is_selected ? colo_t::white : colo_t::blue);
         }
-        sdl.draw_node(graph, graph->is_selected ? colo_t::white : colo_t::red);
+        sdl.draw_node(engine.graph, engine.graph->is_selected ? colo_t::white : colo_t::red);
+        sdl.draw_plot_panel(engine.plot_panel);
+        sdl.draw_pistons(tile_to_pixel_p(engine.x_tiles - 9), tile_to_pixel_p(engine.y_tiles - 2), engine.pistons);
+        sdl.draw_throttle_ports(tile_to_pixel_p(engine.x_tiles - 9), tile_to_pixel_p(1), engine.throttle_ports);
+        if(sdl.is_pause_mode == false)
+        {
+            engine.reset_all_nodes_work_time();
+        }
+    }
+
+    /* the flip waits on the display, so it is never done holding the engine lock */
+
+    void render_ui(double frame_time_ms, double sim_time_ms, const std::string& message)
+    {
+        int x_margin_p = tile_to_pixel_p(0.5); /* todo: top level DSL for GUI coords in ui_n */
+        int y_margin_p = tile_to_pixel_p(0.5);
+        sdl.lock();
+        sdl.clear();
+        sdl.draw_grid();
+        render_engine();
         sdl.draw_selection_box();
         sdl.draw_running_animation_frame(x_margin_p, y_margin_p, frame_time_ms, sim_time_ms, is_slowmo_mode); /* todo: put filename in title (it will eventually be from command line) */
-        sdl.draw_command_message(x_margin_p, sdl.yres_p - tile_to_pixel_p(1), command_message);
-        sdl.draw_plot_panel(plot_panel);
-        sdl.draw_pistons(tile_to_pixel_p(x_tiles - 9), tile_to_pixel_p(y_tiles - 2), pistons);
-        sdl.draw_throttle_ports(tile_to_pixel_p(x_tiles - 9), tile_to_pixel_p(1), throttle_ports);
+        sdl.draw_command_message(x_margin_p, sdl.yres_p - tile_to_pixel_p(1), message);
         sdl.unlock();
         sdl.flip();
         sdl.render_ticks++;
@@ -955,38 +693,47 @@ struct ensim_t
     void run()
     {
         double frame_time_ms = 0;
-        run_sim_once();
+        engine.run_sim_once();
+        sim_thread = std::thread{&ensim_t::run_sim_thread, this};
         int frames [[maybe_unused]] = 0;
         while(not is_done)
         {
             auto t0 = std::chrono::high_resolution_clock::now();
-            sdl.handle_input();
-            if(sdl.is_pause_mode == false)
+            double last_sim_time_ms = 0.0;
+            std::string last_command_message = "";
+            {
+                /* the simulation thread writes the step time, and the message when a step throws */
+                std::lock_guard<std::mutex> lock{engine_mutex};
+                sdl.handle_input();
+                last_sim_time_ms = sim_time_ms;
+                last_command_message = command_message;
+            }
+            if(is_execution_flow_demo_requested)
             {
-                reset_all_nodes_work_time();
-                sync_all_nodes();
-                run_sim();
+                is_execution_flow_demo_requested = false;
+                draw_execution_flow_demo();
             }
-            auto t1 = std::chrono::high_resolution_clock::now();
-            double sim_time_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e6;
+            else
             if(sdl.is_help_mode)
             {
                 render_help_screen();
             }
             else
             {
-                render_ui(frame_time_ms, sim_time_ms);
+                render_ui(frame_time_ms, last_sim_time_ms, last_command_message);
             }
-            auto t2 = std::chrono::high_resolution_clock::now();
-            frame_time_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / 1e6;
-            sdl.controller_delay(frame_time_ms + sim_time_ms);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            frame_time_ms = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e6;
+            sdl.delay(sim_n::frame_time_ms - frame_time_ms);
 #ifdef PERF
             frames++;
             if(frames == 120) /* todo: this is a magic number */
             {
-                break;
+                is_done = true;
             }
 #endif
         }
+        sim_thread.join();
+        apply_input({0, "stop", 0, 0, {}, input_log_t::calc_digest(engine)});
     }
 };
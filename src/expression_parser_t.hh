@@ -7,13 +7,118 @@
  * expression ::= term { ("+" | "-") term }
  */
 
+enum class opcode_t
+{
+    push_constant, push_slot, negate, add, subtract, multiply, divide, modulo
+};
+
+struct instruction_t
+{
+    opcode_t opcode = opcode_t::push_constant;
+    double constant = 0.0;
+    const double* slot = nullptr;
+};
+
+/* an expression compiled to a program for a small stack machine - identifiers are resolved
+ * to the doubles behind them when compiled, so evaluating it looks nothing up and can be done
+ * every cycle. the slots point into node and engine fields, so a program is only good until
+ * the fields it reads move */
+
+struct expression_t
+{
+    std::vector<instruction_t> program;
+
+    std::vector<const double*> get_slots() const
+    {
+        std::vector<const double*> slots;
+        for(const instruction_t& instruction : program)
+        {
+            if(instruction.opcode == opcode_t::push_slot)
+            {
+                slots.push_back(instruction.slot);
+            }
+        }
+        return slots;
+    }
+
+    bool reads_props() const
+    {
+        return std::any_of(
+            program.begin(), program.end(),
+            [](const instruction_t& instruction)
+            {
+                return instruction.opcode == opcode_t::push_slot;
+            }
+        );
+    }
+
+    double eval() const
+    {
+        std::array<double, sim_n::max_expression_depth> stack;
+        int top = -1;
+        for(const instruction_t& instruction : program)
+        {
+            opcode_t opcode = instruction.opcode;
+            if(opcode == opcode_t::push_constant)
+            {
+                stack[++top] = instruction.constant;
+            }
+            else
+            if(opcode == opcode_t::push_slot)
+            {
+                stack[++top] = *instruction.slot;
+            }
+            else
+            if(opcode == opcode_t::negate)
+            {
+                stack[top] = -stack[top];
+            }
+            else
+            {
+                double b = stack[top--];
+                stack[top] = apply(opcode, stack[top], b);
+            }
+        }
+        return stack[top];
+    }
+
+    static double apply(opcode_t opcode, double a, double b)
+    {
+        if(opcode == opcode_t::add)
+        {
+            return a + b;
+        }
+        else
+        if(opcode == opcode_t::subtract)
+        {
+            return a - b;
+        }
+        else
+        if(opcode == opcode_t::multiply)
+        {
+            return a * b;
+        }
+        else
+        if(opcode == opcode_t::divide)
+        {
+            return a / b;
+        }
+        return std::fmod(a, b);
+    }
+};
+
+/* compiles rather than evaluates - operations on constants are folded as they are emitted,
+ * so an expression that reads no props compiles to a single constant */
+
 struct expression_parser_t
 {
     int at = 0;
-    std::function<double(std::string)> lookup = nullptr;
+    int depth = 0;
+    std::function<const double*(std::string_view)> resolve = nullptr;
+    expression_t compiled;
 
-    expression_parser_t(std::function<double(std::string)> lookup)
-        : lookup{lookup}
+    expression_parser_t(std::function<const double*(std::string_view)> resolve)
+        : resolve{resolve}
         {
         }
 
@@ -38,14 +143,52 @@ struct expression_parser_t
         return c;
     }
 
-    double number(const std::string& s)
+    void push(const instruction_t& instruction)
+    {
+        if(++depth > sim_n::max_expression_depth)
+        {
+            throw std::invalid_argument("expression is nested too deeply");
+        }
+        compiled.program.push_back(instruction);
+    }
+
+    void emit_negate()
+    {
+        instruction_t& a = compiled.program.back();
+        if(a.opcode == opcode_t::push_constant)
+        {
+            a.constant = -a.constant;
+        }
+        else
+        {
+            compiled.program.push_back({opcode_t::negate});
+        }
+    }
+
+    void emit_binary(opcode_t opcode)
+    {
+        std::vector<instruction_t>& program = compiled.program;
+        int size = program.size();
+        depth--;
+        if(program[size - 1].opcode == opcode_t::push_constant and program[size - 2].opcode == opcode_t::push_constant)
+        {
+            program[size - 2].constant = expression_t::apply(opcode, program[size - 2].constant, program[size - 1].constant);
+            program.pop_back();
+        }
+        else
+        {
+            program.push_back({opcode});
+        }
+    }
+
+    void number(const std::string& s)
     {
         std::string d = "";
         while(std::isdigit(peek(s)) or peek(s) == '.')
         {
             d += read(s);
         }
-        return std::stod(d);
+        push({opcode_t::push_constant, std::stod(d)});
     }
 
     std::string identifier(const std::string& s)
@@ -58,7 +201,7 @@ struct expression_parser_t
         return l;
     }
 
-    double factor(const std::string& s)
+    void factor(const std::string& s)
     {
         char c = peek(s);
         if(std::isalpha(c))
@@ -66,107 +209,114 @@ struct expression_parser_t
             std::string ident = identifier(s);
             if(ident == "pi")
             {
-                return M_PI;
+                push({opcode_t::push_constant, M_PI});
             }
             else
             if(ident == "otto")
             {
-                return sim_n::four_stroke_r;
+                push({opcode_t::push_constant, sim_n::four_stroke_r});
             }
             else
             if(ident == "k")
             {
-                return thermofluidics_n::stp_static_temperature_k;
+                push({opcode_t::push_constant, thermofluidics_n::stp_static_temperature_k});
             }
             else
             if(ident == "atm")
             {
-                return thermofluidics_n::ntp_static_pressure_pa;
+                push({opcode_t::push_constant, thermofluidics_n::ntp_static_pressure_pa});
             }
             else
-            if(lookup)
+            if(const double* slot = resolve ? resolve(ident) : nullptr)
             {
-                return lookup(ident);
+                push({opcode_t::push_slot, 0.0, slot});
             }
             else
             {
-                return 0.0;
+                push({opcode_t::push_constant, 0.0});
             }
         }
         else
         if(c == '-')
         {
             read(s);
-            return -factor(s);
+            factor(s);
+            emit_negate();
         }
         else
         if(c == '(')
         {
             read(s);
-            double val = expression(s);
+            expression(s);
             read(s);
-            return val;
         }
         else
-            return number(s);
+            number(s);
     }
 
-    double term(const std::string& s)
+    void term(const std::string& s)
     {
-        double a = factor(s);
+        factor(s);
         while(peek(s) == '*' or peek(s) == '%' or peek(s) == '/')
         {
             char op = read(s);
-            double b = factor(s);
+            factor(s);
             if(op == '*')
             {
-                a *= b;
+                emit_binary(opcode_t::multiply);
             }
             else
             if(op == '%')
             {
-                a = std::fmod(a, b);
+                emit_binary(opcode_t::modulo);
             }
             else
             if(op == '/')
             {
-                a /= b;
+                emit_binary(opcode_t::divide);
             }
         }
-        return a;
     }
 
-    double expression(const std::string& s)
+    void expression(const std::string& s)
     {
-        double a = term(s);
+        term(s);
         while(peek(s) == '-' or peek(s) == '+')
         {
             char op = read(s);
-            double b = term(s);
+            term(s);
             if(op == '-')
             {
-                a -= b;
+                emit_binary(opcode_t::subtract);
             }
             else
             if(op == '+')
             {
-                a += b;
+                emit_binary(opcode_t::add);
             }
         }
-        return a;
     }
 
-    double parse(const std::string& s)
+    /* anything that does not parse compiles to zero */
+
+    expression_t compile(const std::string& s)
     {
         at = 0;
+        depth = 0;
+        compiled.program.clear();
         try
         {
-            return expression(s);
+            expression(s);
+            return compiled;
         }
         catch(...)
         {
-            return 0.0;
+            return expression_t{{{opcode_t::push_constant, 0.0, nullptr}}};
         }
     }
-};
 
+    double parse(const std::string& s)
+    {
+        return compile(s).eval();
+    }
+};
@@ -92,49 +92,78 @@ struct gain_filter_t
     }
 };
 
+/* an impulse response is read only once loaded, so every engine in a process
+ * shares one copy per file rather than loading its own */
+
+using impulse_t = std::array<double, sim_n::impulse_size>;
+
+std::shared_ptr<const impulse_t> load_shared_impulse(const std::string& filename)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<const impulse_t>> impulses;
+    std::lock_guard<std::mutex> lock{mutex};
+    std::shared_ptr<const impulse_t> shared_impulse = impulses[filename].lock();
+    if(shared_impulse == nullptr)
+    {
+        std::shared_ptr<impulse_t> impulse = std::make_shared<impulse_t>();
+        impulse->fill(0.0);
+        std::ifstream file(filename);
+        if(file.good() == false)
+        {
+            throw std::runtime_error("could not open " + filename);
+        }
+        int index = 0;
+        double value;
+        while(index < sim_n::impulse_size and file >> value)
+        {
+            (*impulse)[index++] = value;
+        }
+        if(index < sim_n::impulse_size)
+        {
+            /* thrown before it is cached, so a bad file is never shared as silence */
+            throw std::runtime_error(filename + " holds " + std::to_string(index) + " of " + std::to_string(sim_n::impulse_size) + " impulse samples");
+        }
+        shared_impulse = impulse;
+        impulses[filename] = shared_impulse;
+    }
+    return shared_impulse;
+}
+
 struct convolution_filter_t
 : filter_t
 {
     int at = 0;
     double buffer[sim_n::impulse_size] = {};
-    double impulse[sim_n::impulse_size] = {};
+    std::shared_ptr<const impulse_t> impulse;
 
     convolution_filter_t(const std::string& impulse_filename)
-    {
-        load_impulse(impulse_filename);
-    }
+        : impulse{load_shared_impulse(impulse_filename)}
+        {
+        }
 
     double filter(double sample) override
     {
         buffer[at] = sample;
+        const double* response = impulse->data();
         double result = 0;
         int y = sim_n::impulse_size;
         int x = y - at;
         for(int i = 0; i < x; i++)
         {
-            result += impulse[i] * buffer[i + at];
+            result += response[i] * buffer[i + at];
         }
         for(int i = x; i < y; i++)
         {
-            result += impulse[i] * buffer[i - x];
+            result += response[i] * buffer[i - x];
         }
         at = (at - 1 + y) % y;
         return result;
     }
 
-    void load_impulse(const std::string& filename)
+    void feed(double sample)
     {
-        std::ifstream file(filename);
-        int index = 0;
-        if(file.good())
-        {
-            double value;
-            while(file >> value)
-            {
-                impulse[index++] = value;
-            }
-        }
-        assert(index == sim_n::impulse_size);
+        buffer[at] = sample;
+        at = (at - 1 + sim_n::impulse_size) % sim_n::impulse_size;
     }
 };
 
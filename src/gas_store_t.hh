@@ -0,0 +1,97 @@
+/* the hot thermodynamic fields of every volume, one contiguous array per field.
+ * each gas_t owns a slot for its lifetime, and arrange() moves slots so that a
+ * volume's slot is its compiled node id - the schedule then walks every field
+ * array front to back. capacity is fixed so that prop table pointers into the
+ * arrays stay valid until the next arrange() */
+
+struct gas_store_t
+{
+    std::vector<double> static_temperature_k;
+    std::vector<double> bulk_momentum_kg_m_per_s;
+    std::vector<double> moles;
+    std::vector<double> air_molar_ratio;
+    std::vector<double> fuel_molar_ratio;
+    std::vector<double> combusted_molar_ratio;
+    std::vector<int*> owner_indices; /* each owner's index, so moving a slot can update it */
+    std::vector<int> free_indices;
+
+    gas_store_t(int capacity)
+        : static_temperature_k(capacity, 0.0)
+        , bulk_momentum_kg_m_per_s(capacity, 0.0)
+        , moles(capacity, 0.0)
+        , air_molar_ratio(capacity, 0.0)
+        , fuel_molar_ratio(capacity, 0.0)
+        , combusted_molar_ratio(capacity, 0.0)
+        , owner_indices(capacity, nullptr)
+        {
+            for(int index = capacity - 1; index >= 0; index--)
+            {
+                free_indices.push_back(index);
+            }
+        }
+
+    gas_store_t(const gas_store_t&) = delete;
+    gas_store_t& operator=(const gas_store_t&) = delete;
+
+    int allocate(int* owner_index)
+    {
+        if(free_indices.empty())
+        {
+            throw std::runtime_error("gas store is full");
+        }
+        int index = free_indices.back();
+        free_indices.pop_back();
+        owner_indices[index] = owner_index;
+        return index;
+    }
+
+    void release(int index)
+    {
+        owner_indices[index] = nullptr;
+        free_indices.push_back(index);
+    }
+
+    void swap(int a, int b)
+    {
+        std::swap(static_temperature_k[a], static_temperature_k[b]);
+        std::swap(bulk_momentum_kg_m_per_s[a], bulk_momentum_kg_m_per_s[b]);
+        std::swap(moles[a], moles[b]);
+        std::swap(air_molar_ratio[a], air_molar_ratio[b]);
+        std::swap(fuel_molar_ratio[a], fuel_molar_ratio[b]);
+        std::swap(combusted_molar_ratio[a], combusted_molar_ratio[b]);
+        std::swap(owner_indices[a], owner_indices[b]);
+        if(owner_indices[a])
+        {
+            *owner_indices[a] = a;
+        }
+        if(owner_indices[b])
+        {
+            *owner_indices[b] = b;
+        }
+    }
+
+    /* moves the slot at each of indices[i] to i - slots owned by anything not listed follow after */
+
+    void arrange(const std::vector<int>& indices)
+    {
+        int size = indices.size();
+        std::vector<int*> owners;
+        for(int index : indices)
+        {
+            owners.push_back(owner_indices[index]);
+        }
+        for(int index = 0; index < size; index++)
+        {
+            swap(index, *owners[index]);
+        }
+        free_indices.clear();
+        int capacity = owner_indices.size();
+        for(int index = capacity - 1; index >= 0; index--)
+        {
+            if(owner_indices[index] == nullptr)
+            {
+                free_indices.push_back(index);
+            }
+        }
+    }
+};
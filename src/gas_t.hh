@@ -1,5 +1,7 @@
-struct gas_t
-: has_prop_table_t
+/* a parcel of gas in flight between two volumes - plain data so that it copies
+ * with memcpy through the mail wheel and carries only what mixing needs */
+
+struct gas_parcel_t
 {
     double static_temperature_k = 0.0;
     double bulk_momentum_kg_m_per_s = 0.0;
@@ -7,54 +9,212 @@ struct gas_t
     double air_molar_ratio = 0.0;
     double fuel_molar_ratio = 0.0;
     double combusted_molar_ratio = 0.0;
+    double velocity_m_per_s = 0.0;
+    int arrival_cycle = 0;
+
+    double calc_gamma() const
+    {
+        return thermofluidics_n::calc_gamma(air_molar_ratio, fuel_molar_ratio, combusted_molar_ratio);
+    }
+
+    /* fuel is injected into the parcel in flight - same adiabatic addition as gas_t::add_fuel_moles */
+
+    void add_fuel_moles(double fuel_moles)
+    {
+        double new_moles = moles + fuel_moles;
+        fuel_molar_ratio = (fuel_molar_ratio * moles + fuel_moles) / new_moles;
+        air_molar_ratio = 1.0 - fuel_molar_ratio;
+        static_temperature_k *= std::pow(new_moles / moles, (calc_gamma() - 1.0) / calc_gamma());
+        moles = new_moles;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<gas_parcel_t>);
+
+/* derived properties memoized between mutations - composition terms change only
+ * when the species ratios do, state terms change whenever anything does */
+
+struct gas_derived_t
+{
+    bool is_composition_valid = false;
+    bool is_state_valid = false;
+    double molar_mass_kg_per_mol = 0.0;
+    double gamma = 0.0;
+    double specific_gas_constant_j_per_kg_k = 0.0;
+    double static_pressure_pa = 0.0;
+    double density_kg_per_m3 = 0.0;
+    double total_pressure_pa = 0.0;
+};
+
+struct gas_t
+: has_prop_table_t
+{
+    gas_store_t& gas_store;
+    int index = 0; /* slot in gas_store - the compiled node id once the schedule is compiled */
     double mol_balance = 0.0; /* tracks volumetric_efficiency... todo: only works on 0pi aligned piston... bugged for rest */
+    mutable gas_derived_t derived;
+
+    gas_t(gas_store_t& gas_store)
+        : gas_store{gas_store}
+        , index{gas_store.allocate(&index)}
+        {
+        }
+
+    gas_t(const gas_t&) = delete;
+    gas_t& operator=(const gas_t&) = delete;
+
+    ~gas_t()
+    {
+        gas_store.release(index);
+    }
+
+    double& static_temperature_k()
+    {
+        return gas_store.static_temperature_k[index];
+    }
+
+    double static_temperature_k() const
+    {
+        return gas_store.static_temperature_k[index];
+    }
+
+    double& bulk_momentum_kg_m_per_s()
+    {
+        return gas_store.bulk_momentum_kg_m_per_s[index];
+    }
+
+    double bulk_momentum_kg_m_per_s() const
+    {
+        return gas_store.bulk_momentum_kg_m_per_s[index];
+    }
+
+    double& moles()
+    {
+        return gas_store.moles[index];
+    }
+
+    double moles() const
+    {
+        return gas_store.moles[index];
+    }
+
+    double& air_molar_ratio()
+    {
+        return gas_store.air_molar_ratio[index];
+    }
+
+    double air_molar_ratio() const
+    {
+        return gas_store.air_molar_ratio[index];
+    }
+
+    double& fuel_molar_ratio()
+    {
+        return gas_store.fuel_molar_ratio[index];
+    }
+
+    double fuel_molar_ratio() const
+    {
+        return gas_store.fuel_molar_ratio[index];
+    }
+
+    double& combusted_molar_ratio()
+    {
+        return gas_store.combusted_molar_ratio[index];
+    }
+
+    double combusted_molar_ratio() const
+    {
+        return gas_store.combusted_molar_ratio[index];
+    }
 
     virtual double calc_volume_m3() const = 0;
     virtual std::string get_volume_name() const = 0;
 
     void normalize()
     {
-        static_temperature_k = thermofluidics_n::ntp_static_temperature_k;
-        bulk_momentum_kg_m_per_s = 0.0;
-        moles = thermofluidics_n::ntp_static_pressure_pa * calc_volume_m3() / (thermofluidics_n::r_j_per_mol_k * static_temperature_k);
-        air_molar_ratio = 1.0;
-        fuel_molar_ratio = 0.0;
-        combusted_molar_ratio = 0.0;
+        static_temperature_k() = thermofluidics_n::ntp_static_temperature_k;
+        bulk_momentum_kg_m_per_s() = 0.0;
+        moles() = thermofluidics_n::ntp_static_pressure_pa * calc_volume_m3() / (thermofluidics_n::r_j_per_mol_k * static_temperature_k());
+        air_molar_ratio() = 1.0;
+        fuel_molar_ratio() = 0.0;
+        combusted_molar_ratio() = 0.0;
         mol_balance = 0.0;
+        invalidate_composition();
+    }
+
+    /* anything that writes the gas fields directly (normalizing, prop edits, volume
+     * resizing) must invalidate, the mutators below do so themselves */
+
+    void invalidate_state()
+    {
+        derived.is_state_valid = false;
+    }
+
+    void invalidate_composition()
+    {
+        derived.is_composition_valid = false;
+        derived.is_state_valid = false;
+    }
+
+    const gas_derived_t& calc_derived_composition() const
+    {
+        if(not derived.is_composition_valid)
+        {
+            derived.molar_mass_kg_per_mol
+                = thermofluidics_n::molar_mass_combusted_kg_per_mol * combusted_molar_ratio()
+                + thermofluidics_n::molar_mass_air_kg_per_mol * air_molar_ratio()
+                + thermofluidics_n::molar_mass_fuel_kg_per_mol * fuel_molar_ratio();
+            derived.gamma = thermofluidics_n::calc_gamma(air_molar_ratio(), fuel_molar_ratio(), combusted_molar_ratio());
+            derived.specific_gas_constant_j_per_kg_k = thermofluidics_n::r_j_per_mol_k / derived.molar_mass_kg_per_mol;
+            derived.is_composition_valid = true;
+        }
+        return derived;
+    }
+
+    const gas_derived_t& calc_derived_state() const
+    {
+        if(not derived.is_state_valid)
+        {
+            double volume_m3 = calc_volume_m3();
+            double mass_kg = moles() * calc_derived_composition().molar_mass_kg_per_mol;
+            double bulk_velocity_m_per_s = bulk_momentum_kg_m_per_s() / mass_kg;
+            derived.static_pressure_pa = (moles() * thermofluidics_n::r_j_per_mol_k * static_temperature_k()) / volume_m3;
+            derived.density_kg_per_m3 = mass_kg / volume_m3;
+            derived.total_pressure_pa = derived.static_pressure_pa + derived.density_kg_per_m3 * std::pow(bulk_velocity_m_per_s, 2.0) / 2.0;
+            derived.is_state_valid = true;
+        }
+        return derived;
     }
 
     prop_table_t get_prop_table() override
     {
         prop_table_t prop_table = {
-            {"gas_static_temperature_k", &static_temperature_k},
-            {"gas_bulk_momentum_kg_m_per_s", &bulk_momentum_kg_m_per_s},
-            {"gas_moles", &moles},
-            {"gas_air_molar_ratio", &air_molar_ratio},
-            {"gas_fuel_molar_ratio", &fuel_molar_ratio},
-            {"gas_combusted_molar_ratio", &combusted_molar_ratio},
+            {"gas_static_temperature_k", &static_temperature_k()},
+            {"gas_bulk_momentum_kg_m_per_s", &bulk_momentum_kg_m_per_s()},
+            {"gas_moles", &moles()},
+            {"gas_air_molar_ratio", &air_molar_ratio()},
+            {"gas_fuel_molar_ratio", &fuel_molar_ratio()},
+            {"gas_combusted_molar_ratio", &combusted_molar_ratio()},
         };
         return prop_table;
     }
 
     double calc_molar_mass_kg_per_mol() const
     {
-        return thermofluidics_n::molar_mass_combusted_kg_per_mol * combusted_molar_ratio
-             + thermofluidics_n::molar_mass_air_kg_per_mol * air_molar_ratio
-             + thermofluidics_n::molar_mass_fuel_kg_per_mol * fuel_molar_ratio;
+        return calc_derived_composition().molar_mass_kg_per_mol;
     }
 
     double calc_gamma() const
     {
-        return thermofluidics_n::gamma_combusted * combusted_molar_ratio
-             + thermofluidics_n::gamma_air * air_molar_ratio
-             + thermofluidics_n::gamma_fuel * fuel_molar_ratio;
+        return calc_derived_composition().gamma;
     }
 
     /* Rs = R / M */
 
     double calc_specific_gas_constant_j_per_kg_k() const
     {
-        return thermofluidics_n::r_j_per_mol_k / calc_molar_mass_kg_per_mol();
+        return calc_derived_composition().specific_gas_constant_j_per_kg_k;
     }
 
     /* cv = Rs / (y - 1) */
@@ -78,14 +238,14 @@ struct gas_t
 
     double calc_dynamic_temperature_k(double mach_number) const
     {
-        return static_temperature_k * (calc_gamma() - 1.0) / 2.0 * std::pow(mach_number, 2.0);
+        return static_temperature_k() * (calc_gamma() - 1.0) / 2.0 * std::pow(mach_number, 2.0);
     }
 
     /* Tt = T + Td */
 
     double calc_total_temperature_k(double mach_number) const
     {
-        return static_temperature_k + calc_dynamic_temperature_k(mach_number);
+        return static_temperature_k() + calc_dynamic_temperature_k(mach_number);
     }
 
     /*     n * R * T
@@ -95,7 +255,7 @@ struct gas_t
 
     double calc_static_pressure_pa() const
     {
-        return (moles * thermofluidics_n::r_j_per_mol_k * static_temperature_k) / calc_volume_m3();
+        return calc_derived_state().static_pressure_pa;
     }
 
     /* P = P - 1 * atm */
@@ -109,21 +269,21 @@ struct gas_t
 
     double calc_mass_kg() const
     {
-        return moles * calc_molar_mass_kg_per_mol();
+        return moles() * calc_molar_mass_kg_per_mol();
     }
 
     /* v = p / m */
 
     double calc_bulk_velocity_m_per_s() const
     {
-        return bulk_momentum_kg_m_per_s / calc_mass_kg();
+        return bulk_momentum_kg_m_per_s() / calc_mass_kg();
     }
 
     /* ρ = m / V */
 
     double calc_density_kg_per_m3() const
     {
-        return calc_mass_kg() / calc_volume_m3();
+        return calc_derived_state().density_kg_per_m3;
     }
 
     /*          2
@@ -141,7 +301,7 @@ struct gas_t
 
     double calc_total_pressure_pa() const
     {
-        return calc_static_pressure_pa() + calc_dynamic_pressure_pa();
+        return calc_derived_state().total_pressure_pa;
     }
 
     double calc_gauge_pressure_pa() const
@@ -155,7 +315,7 @@ struct gas_t
 
     double calc_max_velocity_m_per_s() const
     {
-        return std::sqrt(calc_gamma() * calc_specific_gas_constant_j_per_kg_k() * static_temperature_k);
+        return std::sqrt(calc_gamma() * calc_specific_gas_constant_j_per_kg_k() * static_temperature_k());
     }
 
     /* pmax = m * vmax */
@@ -190,42 +350,64 @@ struct gas_t
 
     void add_moles_adiabatically(double delta_moles)
     {
-        double new_moles = moles + delta_moles;
+        double new_moles = moles() + delta_moles;
         if(new_moles < 0.0)
         {
             throw std::runtime_error("negative mole count encountered in: " + get_volume_name());
         }
         mol_balance += delta_moles;
-        static_temperature_k *= std::pow(new_moles / moles, (calc_gamma() - 1.0) / calc_gamma());
-        moles = new_moles;
+        static_temperature_k() *= std::pow(new_moles / moles(), (calc_gamma() - 1.0) / calc_gamma());
+        moles() = new_moles;
+        invalidate_state();
     }
 
+    static constexpr double air_fuel_mass_upper_ratio_cap = 999.999999; /* so that it displys visibly on plot */
+
     double calc_air_fuel_mass_ratio() const
     {
-        double air_fuel_mass_upper_ratio_cap = 999.999999; /* so that it displys visibly on plot */
-        if(fuel_molar_ratio == 0.0)
+        if(fuel_molar_ratio() == 0.0)
         {
             return air_fuel_mass_upper_ratio_cap;
         }
-        double air_mass_kg = air_molar_ratio * moles * thermofluidics_n::molar_mass_air_kg_per_mol;
-        double fuel_mass_kg = fuel_molar_ratio * moles * thermofluidics_n::molar_mass_fuel_kg_per_mol;
+        double air_mass_kg = air_molar_ratio() * moles() * thermofluidics_n::molar_mass_air_kg_per_mol;
+        double fuel_mass_kg = fuel_molar_ratio() * moles() * thermofluidics_n::molar_mass_fuel_kg_per_mol;
         double air_fuel_mass_ratio = air_mass_kg / fuel_mass_kg;
         air_fuel_mass_ratio = std::clamp(air_fuel_mass_ratio, 0.0, air_fuel_mass_upper_ratio_cap);
         return air_fuel_mass_ratio;
     }
 
+    /* what a wideband sensor reads - combusted gas is counted back
+     * as the stoichiometric air and fuel that formed it */
+
+    double calc_equivalent_air_fuel_mass_ratio() const
+    {
+        double air_mass_kg = air_molar_ratio() * moles() * thermofluidics_n::molar_mass_air_kg_per_mol;
+        double fuel_mass_kg = fuel_molar_ratio() * moles() * thermofluidics_n::molar_mass_fuel_kg_per_mol;
+        double combusted_mass_kg = combusted_molar_ratio() * moles() * thermofluidics_n::molar_mass_combusted_kg_per_mol;
+        double combusted_fuel_mass_kg = combusted_mass_kg / (1.0 + thermofluidics_n::air_fuel_stoich_ratio);
+        fuel_mass_kg += combusted_fuel_mass_kg;
+        air_mass_kg += combusted_mass_kg - combusted_fuel_mass_kg;
+        if(fuel_mass_kg == 0.0)
+        {
+            return air_fuel_mass_upper_ratio_cap;
+        }
+        return std::clamp(air_mass_kg / fuel_mass_kg, 0.0, air_fuel_mass_upper_ratio_cap);
+    }
+
     void add_fuel_moles(double fuel_moles)
     {
-        fuel_molar_ratio = (fuel_molar_ratio * moles + fuel_moles) / (moles + fuel_moles);
-        air_molar_ratio = 1.0 - fuel_molar_ratio;
+        fuel_molar_ratio() = (fuel_molar_ratio() * moles() + fuel_moles) / (moles() + fuel_moles);
+        air_molar_ratio() = 1.0 - fuel_molar_ratio();
+        invalidate_composition();
         add_moles_adiabatically(fuel_moles);
     }
 
-    void add_momentum(double bulk_momentum_kg_m_per_s)
+    void add_momentum(double delta_bulk_momentum_kg_m_per_s)
     {
-        this->bulk_momentum_kg_m_per_s += bulk_momentum_kg_m_per_s;
+        bulk_momentum_kg_m_per_s() += delta_bulk_momentum_kg_m_per_s;
         double max_bulk_momentum_kg_m_per_s = calc_max_bulk_momentum_kg_m_per_s();
-        this->bulk_momentum_kg_m_per_s = std::clamp(this->bulk_momentum_kg_m_per_s, -max_bulk_momentum_kg_m_per_s, max_bulk_momentum_kg_m_per_s);
+        bulk_momentum_kg_m_per_s() = std::clamp(bulk_momentum_kg_m_per_s(), -max_bulk_momentum_kg_m_per_s, max_bulk_momentum_kg_m_per_s);
+        invalidate_state();
     }
 
     /*                   (y - 1)
@@ -236,23 +418,25 @@ struct gas_t
 
     void compress_adiabatically(double compression_ratio_m3)
     {
-        static_temperature_k *= std::pow(compression_ratio_m3, calc_gamma() - 1.0);
+        static_temperature_k() *= std::pow(compression_ratio_m3, calc_gamma() - 1.0);
+        invalidate_state();
     }
 
-    void mix_in(const gas_t& gas)
+    void mix_in(const gas_parcel_t& gas)
     {
         add_moles_adiabatically(gas.moles);
         add_momentum(gas.bulk_momentum_kg_m_per_s);
-        air_molar_ratio = calc_weighted_average(air_molar_ratio, moles, gas.air_molar_ratio, gas.moles);
-        fuel_molar_ratio = calc_weighted_average(fuel_molar_ratio, moles, gas.fuel_molar_ratio, gas.moles);
-        combusted_molar_ratio = calc_weighted_average(combusted_molar_ratio, moles, gas.combusted_molar_ratio, gas.moles);
-        static_temperature_k = calc_weighted_average(static_temperature_k, moles, gas.static_temperature_k, gas.moles);
+        air_molar_ratio() = calc_weighted_average(air_molar_ratio(), moles(), gas.air_molar_ratio, gas.moles);
+        fuel_molar_ratio() = calc_weighted_average(fuel_molar_ratio(), moles(), gas.fuel_molar_ratio, gas.moles);
+        combusted_molar_ratio() = calc_weighted_average(combusted_molar_ratio(), moles(), gas.combusted_molar_ratio, gas.moles);
+        static_temperature_k() = calc_weighted_average(static_temperature_k(), moles(), gas.static_temperature_k, gas.moles);
+        invalidate_composition();
     }
 
     void burn_fuel_by_moles(double burning_moles)
     {
-        double burning_air_moles = burning_moles * air_molar_ratio;
-        double burning_fuel_moles = burning_moles * fuel_molar_ratio;
+        double burning_air_moles = burning_moles * air_molar_ratio();
+        double burning_fuel_moles = burning_moles * fuel_molar_ratio();
         double burning_air_mass_kg = burning_air_moles * thermofluidics_n::molar_mass_air_kg_per_mol;
         double burning_fuel_mass_kg = burning_fuel_moles * thermofluidics_n::molar_mass_fuel_kg_per_mol;
         if(burning_air_mass_kg / burning_fuel_mass_kg > thermofluidics_n::air_fuel_stoich_ratio)
@@ -263,9 +447,9 @@ struct gas_t
         {
             burning_fuel_mass_kg = burning_air_mass_kg / thermofluidics_n::air_fuel_stoich_ratio;
         }
-        double air_moles = moles * air_molar_ratio;
-        double fuel_moles = moles * fuel_molar_ratio;
-        double combusted_moles = moles * combusted_molar_ratio;
+        double air_moles = moles() * air_molar_ratio();
+        double fuel_moles = moles() * fuel_molar_ratio();
+        double combusted_moles = moles() * combusted_molar_ratio();
         double air_mass_kg = air_moles * thermofluidics_n::molar_mass_air_kg_per_mol;
         double fuel_mass_kg = fuel_moles * thermofluidics_n::molar_mass_fuel_kg_per_mol;
         double combusted_mass_kg = combusted_moles * thermofluidics_n::molar_mass_combusted_kg_per_mol;
@@ -276,11 +460,13 @@ struct gas_t
         double new_fuel_moles = fuel_mass_kg / thermofluidics_n::molar_mass_fuel_kg_per_mol;
         double new_combusted_moles = combusted_mass_kg / thermofluidics_n::molar_mass_combusted_kg_per_mol;
         double new_total_moles = new_air_moles + new_fuel_moles + new_combusted_moles;
-        air_molar_ratio = new_air_moles / new_total_moles;
-        fuel_molar_ratio = new_fuel_moles / new_total_moles;
-        combusted_molar_ratio = new_combusted_moles / new_total_moles;
+        air_molar_ratio() = new_air_moles / new_total_moles;
+        fuel_molar_ratio() = new_fuel_moles / new_total_moles;
+        combusted_molar_ratio() = new_combusted_moles / new_total_moles;
+        invalidate_composition();
         double energy_released_j = burning_fuel_mass_kg * thermofluidics_n::fuel_lower_heating_value_j_per_kg;
-        static_temperature_k += energy_released_j / (calc_mass_kg() * calc_specific_heat_capacity_at_constant_volume_j_per_kg_k());
+        static_temperature_k() += energy_released_j / (calc_mass_kg() * calc_specific_heat_capacity_at_constant_volume_j_per_kg_k());
+        invalidate_state();
     }
 
     void burn_fuel_by_volume(double burning_volume_m3)
@@ -292,46 +478,14 @@ struct gas_t
     }
 };
 
-struct gas_parcel_t
+struct flowing_gas_t
 : gas_t
 {
-    int arrival_cycle = 0;
-    double velocity_m_per_s = 0.0;
-
-    double calc_volume_m3() const override
-    {
-        throw std::logic_error("gas parcels are dimensionless");
-    }
-
-    std::string get_volume_name() const override
-    {
-        throw std::logic_error("gas parcels are nameless");
-    }
-
-    gas_parcel_t(double static_temperature_k, double bulk_momentum_kg_m_per_s, double moles, double air_molar_ratio, double fuel_molar_ratio, double combusted_molar_ratio, int arrival_cycle, double velocity_m_per_s)
-        : arrival_cycle{arrival_cycle}
-        , velocity_m_per_s{velocity_m_per_s}
+    flowing_gas_t(gas_store_t& gas_store)
+        : gas_t{gas_store}
         {
-            this->static_temperature_k = static_temperature_k;
-            this->bulk_momentum_kg_m_per_s = bulk_momentum_kg_m_per_s;
-            this->moles = moles;
-            this->air_molar_ratio = air_molar_ratio;
-            this->fuel_molar_ratio = fuel_molar_ratio;
-            this->combusted_molar_ratio = combusted_molar_ratio;
         }
 
-    bool operator>(const gas_parcel_t& other) const
-    {
-        return arrival_cycle > other.arrival_cycle;
-    }
-};
-
-struct flowing_gas_t
-: gas_t
-{
-    virtual double calc_flow_area_m2() const = 0;
-    virtual double calc_flow_length_m() const = 0;
-
     /*                                          -(y + 1)
      *                _____                     ---------
      * .    A P0     /  y          (y - 1)  2   2(y - 1)
@@ -340,9 +494,9 @@ struct flowing_gas_t
      *      \/T0
      */
 
-    double calc_mass_flow_rate_kg_per_s(double mach_number) const
+    double calc_mass_flow_rate_kg_per_s(const port_t& port, double mach_number) const
     {
-        double term1 = calc_flow_area_m2() * calc_total_pressure_pa() / std::sqrt(calc_total_temperature_k(mach_number));
+        double term1 = port.calc_flow_area_m2() * calc_total_pressure_pa() / std::sqrt(calc_total_temperature_k(mach_number));
         double term2 = std::sqrt(calc_gamma() / calc_specific_gas_constant_j_per_kg_k()) * mach_number;
         double term3 = std::pow(1.0 + (calc_gamma() - 1.0) / 2.0 * std::pow(mach_number, 2.0), - (calc_gamma() + 1.0) / (2.0 * (calc_gamma() - 1.0)));
         return term1 * term2 * term3;
@@ -365,19 +519,21 @@ struct flowing_gas_t
      *     pt * A
      */
 
-    double calc_velocity_m_per_s(double mach_number) const
+    double calc_velocity_m_per_s(const port_t& port, double mach_number) const
     {
-        return calc_mass_flow_rate_kg_per_s(mach_number) / (calc_total_density_kg_per_m3(mach_number) * calc_flow_area_m2());
+        return calc_mass_flow_rate_kg_per_s(port, mach_number) / (calc_total_density_kg_per_m3(mach_number) * port.calc_flow_area_m2());
     }
 
-    gas_parcel_t package_gas_parcel(double mach_number, int cycle)
+    /* dt_s is the time the parcel flows for - arrival stays in whole sample cycles */
+
+    gas_parcel_t package_gas_parcel(const port_t& port, double mach_number, int cycle, double dt_s) const
     {
-        double velocity_m_per_s = calc_velocity_m_per_s(mach_number);
-        double mass_flowed_kg = calc_mass_flow_rate_kg_per_s(mach_number) * sim_n::dt_s;
+        double velocity_m_per_s = calc_velocity_m_per_s(port, mach_number);
+        double mass_flowed_kg = calc_mass_flow_rate_kg_per_s(port, mach_number) * dt_s;
         double moles_flowed = mass_flowed_kg / calc_molar_mass_kg_per_mol();
         double bulk_momentum_flowed_kg_m_per_s = mass_flowed_kg * velocity_m_per_s;
-        int travel_cycles = calc_flow_length_m() / (velocity_m_per_s * sim_n::dt_s);
+        int travel_cycles = port.length_m / (velocity_m_per_s * sim_n::dt_s);
         int arrival_cycle = travel_cycles + cycle;
-        return gas_parcel_t{static_temperature_k, bulk_momentum_flowed_kg_m_per_s, moles_flowed, air_molar_ratio, fuel_molar_ratio, combusted_molar_ratio, arrival_cycle, velocity_m_per_s};
+        return gas_parcel_t{static_temperature_k(), bulk_momentum_flowed_kg_m_per_s, moles_flowed, air_molar_ratio(), fuel_molar_ratio(), combusted_molar_ratio(), velocity_m_per_s, arrival_cycle};
     }
 };
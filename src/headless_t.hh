@@ -0,0 +1,133 @@
+/* ensim3 --headless [file] [--seconds s] [--throttle ratio] [--threads n] [--detail full|reduced|minimal]
+ *                   [--checkpoint in.ckpt] [--save-checkpoint out.ckpt] [--out file.wav|file.pcm|-]
+ *
+ * loads an engine and runs it as fast as the cpu allows without initializing sdl,
+ * streaming the collector audio to a wav file, or as raw 32 bit float pcm to a file
+ * or stdout - used for batch rendering and load testing on machines without a display.
+ * a run can resume from a checkpoint rather than start from the engine file, and can
+ * leave a checkpoint of where it ended */
+
+struct headless_t
+{
+    std::string filename = "engines/test.ensim3";
+    std::string out_filename = "-";
+    std::string checkpoint_filename = "";
+    std::string save_checkpoint_filename = "";
+    double seconds = 10.0;
+    std::optional<double> throttle;
+    std::optional<detail_level_t> detail_level; /* a checkpoint carries its own */
+    engine_t engine;
+
+    headless_t(const std::vector<std::string>& args)
+    {
+        int size = args.size();
+        for(int i = 0; i < size; i++)
+        {
+            const std::string& arg = args[i];
+            bool has_value = i + 1 < size;
+            if(arg == "--headless")
+            {
+                if(has_value and args[i + 1].starts_with("--") == false)
+                {
+                    filename = args[++i];
+                }
+            }
+            else
+            if(arg == "--seconds" and has_value)
+            {
+                seconds = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--throttle" and has_value)
+            {
+                throttle = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--threads" and has_value)
+            {
+                engine.max_worker_threads = std::stoi(args[++i]);
+            }
+            else
+            if(arg == "--detail" and has_value)
+            {
+                detail_level = parse_detail_level(args[++i]);
+            }
+            else
+            if(arg == "--checkpoint" and has_value)
+            {
+                checkpoint_filename = args[++i];
+            }
+            else
+            if(arg == "--save-checkpoint" and has_value)
+            {
+                save_checkpoint_filename = args[++i];
+            }
+            else
+            if(arg == "--out" and has_value)
+            {
+                out_filename = args[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("unknown or incomplete argument: " + arg);
+            }
+        }
+    }
+
+    int run()
+    {
+        if(checkpoint_filename.empty() == false)
+        {
+            filename = checkpoint_filename;
+            checkpoint_t::load(checkpoint_filename).restore(engine);
+        }
+        else
+        if(engine.load_nodes_from_disk(filename) == false or engine.graph == nullptr)
+        {
+            throw std::runtime_error("could not load " + filename);
+        }
+        if(throttle)
+        {
+            engine.throttle_cable.pull_ratio_setpoint = *throttle;
+        }
+        if(detail_level)
+        {
+            engine.set_detail_level(*detail_level);
+        }
+        pcm_writer_t writer{out_filename};
+        std::vector<float>& buffer = engine.audio_processor.buffer;
+        int cycles = seconds * sim_n::sample_frequency_hz;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < cycles; i++)
+        {
+            try
+            {
+                engine.run_sim_once();
+            }
+            catch(const std::exception& exception)
+            {
+                engine.normalize_all_nodes();
+                std::cerr << exception.what() << "\n";
+            }
+            int buffered = buffer.size();
+            if(buffered >= sim_n::cycles_per_frame)
+            {
+                writer.write(buffer);
+                buffer.clear();
+            }
+        }
+        writer.write(buffer);
+        buffer.clear();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        if(save_checkpoint_filename.empty() == false)
+        {
+            checkpoint_t::capture(engine).save(save_checkpoint_filename);
+        }
+        double wall_time_s = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e9;
+        std::cerr
+            << "rendered " << double_to_string(seconds, 2) << " s of " << filename
+            << " in " << double_to_string(wall_time_s, 2) << " s"
+            << " (" << double_to_string(seconds / wall_time_s, 2) << "x real time)\n";
+        return 0;
+    }
+};
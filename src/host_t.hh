@@ -0,0 +1,255 @@
+/* ensim3 --host [file] [--engines n] [--throttles from:to] [--seconds s] [--threads n]
+ *               [--detail full|reduced|minimal] [--checkpoint in.ckpt] [--out mix.wav|mix.pcm|-]
+ *
+ * runs many independent engines in one process - one per vehicle on a game server -
+ * each with its own crank, cams, throttle and audio processor. a frame at a time, the
+ * engines are stepped across a worker pool and their audio is summed into one stream
+ * by a mixing bus, each engine at its own gain. read only data (impulse responses) is
+ * shared between the engines, and each engine runs at its own level of detail so that
+ * distant vehicles cost less. from the command line every engine runs the same file,
+ * at the same detail, at throttles spread evenly from one end of the given range to the
+ * other, either from a cold start or all seeded from one checkpoint */
+
+struct host_engine_t
+{
+    std::unique_ptr<engine_t> engine;
+    double gain = 1.0;
+    int faults = 0;
+};
+
+struct mixing_bus_t
+{
+    std::vector<float> mix;
+
+    void clear(int frames)
+    {
+        mix.assign(frames, 0.0f);
+    }
+
+    /* an engine that did not turn every step buffers fewer samples - the rest of its frame is silence */
+
+    void mix_in(const std::vector<float>& buffer, double gain)
+    {
+        int size = std::min(buffer.size(), mix.size());
+        for(int index = 0; index < size; index++)
+        {
+            mix[index] += gain * buffer[index];
+        }
+    }
+
+    void clamp()
+    {
+        for(float& sample : mix)
+        {
+            sample = std::clamp(sample, -1.0f, 1.0f);
+        }
+    }
+};
+
+struct host_t
+{
+    std::vector<host_engine_t> engines;
+    worker_pool_t workers;
+    mixing_bus_t mixing_bus;
+
+    host_t(int thread_count)
+    {
+        workers.resize(std::max(0, thread_count - 1));
+    }
+
+    engine_t& add_engine(const std::string& filename, double gain)
+    {
+        std::unique_ptr<engine_t> engine = std::make_unique<engine_t>();
+        engine->max_worker_threads = 0; /* the engines are the parallelism */
+        if(engine->load_nodes_from_disk(filename) == false or engine->graph == nullptr)
+        {
+            throw std::runtime_error("could not load " + filename);
+        }
+        engines.push_back({std::move(engine), gain});
+        return *engines.back().engine;
+    }
+
+    engine_t& add_engine(const checkpoint_t& checkpoint, double gain)
+    {
+        std::unique_ptr<engine_t> engine = std::make_unique<engine_t>();
+        engine->max_worker_threads = 0;
+        checkpoint.restore(*engine);
+        engines.push_back({std::move(engine), gain});
+        return *engines.back().engine;
+    }
+
+    /* steps every engine a frame and returns the mix of their audio */
+
+    const std::vector<float>& run_frame()
+    {
+        workers.run(engines.size(),
+            [this](int index)
+            {
+                host_engine_t& host_engine = engines[index];
+                for(int cycle = 0; cycle < sim_n::cycles_per_frame; cycle++)
+                {
+                    try
+                    {
+                        host_engine.engine->run_sim_once();
+                    }
+                    catch(const std::exception&)
+                    {
+                        host_engine.engine->normalize_all_nodes();
+                        host_engine.faults++;
+                    }
+                }
+            }
+        );
+        mixing_bus.clear(sim_n::cycles_per_frame);
+        for(host_engine_t& host_engine : engines)
+        {
+            std::vector<float>& buffer = host_engine.engine->audio_processor.buffer;
+            mixing_bus.mix_in(buffer, host_engine.gain);
+            buffer.clear();
+        }
+        mixing_bus.clamp();
+        return mixing_bus.mix;
+    }
+};
+
+struct host_cli_t
+{
+    std::string filename = "engines/test.ensim3";
+    std::string out_filename = "-";
+    std::string checkpoint_filename = "";
+    int engine_count = 16;
+    double from_throttle = 0.3;
+    double to_throttle = 0.9;
+    double seconds = 10.0;
+    detail_level_t detail_level = detail_level_t::full;
+    int thread_count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    host_cli_t(const std::vector<std::string>& args)
+    {
+        int size = args.size();
+        for(int i = 0; i < size; i++)
+        {
+            const std::string& arg = args[i];
+            bool has_value = i + 1 < size;
+            if(arg == "--host")
+            {
+                if(has_value and args[i + 1].starts_with("--") == false)
+                {
+                    filename = args[++i];
+                }
+            }
+            else
+            if(arg == "--engines" and has_value)
+            {
+                engine_count = std::max(1, std::stoi(args[++i]));
+            }
+            else
+            if(arg == "--throttles" and has_value)
+            {
+                parse_throttles(args[++i]);
+            }
+            else
+            if(arg == "--seconds" and has_value)
+            {
+                seconds = std::stod(args[++i]);
+            }
+            else
+            if(arg == "--threads" and has_value)
+            {
+                thread_count = std::max(1, std::stoi(args[++i]));
+            }
+            else
+            if(arg == "--detail" and has_value)
+            {
+                detail_level = parse_detail_level(args[++i]);
+            }
+            else
+            if(arg == "--checkpoint" and has_value)
+            {
+                checkpoint_filename = args[++i];
+            }
+            else
+            if(arg == "--out" and has_value)
+            {
+                out_filename = args[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("unknown or incomplete argument: " + arg);
+            }
+        }
+    }
+
+    /* "from:to" - the engine count says how many throttles are spread across it */
+
+    void parse_throttles(const std::string& throttles)
+    {
+        std::string message = "expected --throttles from:to, got: " + throttles;
+        size_t pos = throttles.find(':');
+        if(pos == std::string::npos or throttles.find(':', pos + 1) not_eq std::string::npos)
+        {
+            throw std::invalid_argument(message);
+        }
+        std::string from = throttles.substr(0, pos);
+        std::string to = throttles.substr(pos + 1);
+        size_t from_size = 0;
+        size_t to_size = 0;
+        try
+        {
+            from_throttle = std::stod(from, &from_size);
+            to_throttle = std::stod(to, &to_size);
+        }
+        catch(const std::exception&)
+        {
+            throw std::invalid_argument(message);
+        }
+        if(from_size not_eq from.size() or to_size not_eq to.size())
+        {
+            throw std::invalid_argument(message);
+        }
+    }
+
+    int run()
+    {
+        host_t host{thread_count};
+        std::vector<double> throttle_ratios;
+        for(int index = 0; index < engine_count; index++)
+        {
+            throttle_ratios.push_back(engine_count == 1 ? from_throttle : from_throttle + (to_throttle - from_throttle) * index / (engine_count - 1));
+        }
+        std::optional<checkpoint_t> checkpoint;
+        if(checkpoint_filename.empty() == false)
+        {
+            filename = checkpoint_filename;
+            checkpoint = checkpoint_t::load(checkpoint_filename);
+        }
+        for(double throttle : throttle_ratios)
+        {
+            engine_t& engine = checkpoint ? host.add_engine(*checkpoint, 1.0 / engine_count) : host.add_engine(filename, 1.0 / engine_count);
+            engine.throttle_cable.pull_ratio_setpoint = throttle;
+            engine.set_detail_level(detail_level);
+        }
+        pcm_writer_t writer{out_filename};
+        int frames = seconds * sim_n::sample_frequency_hz / sim_n::cycles_per_frame;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for(int frame = 0; frame < frames; frame++)
+        {
+            const std::vector<float>& mix = host.run_frame();
+            writer.write(mix);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double wall_time_s = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e9;
+        double rendered_s = frames * sim_n::cycles_per_frame / sim_n::sample_frequency_hz;
+        int faults = 0;
+        for(const host_engine_t& host_engine : host.engines)
+        {
+            faults += host_engine.faults;
+        }
+        std::cerr
+            << "hosted " << engine_count << " engines of " << filename
+            << " for " << double_to_string(rendered_s, 2) << " s"
+            << " on " << thread_count << " thread(s) in " << double_to_string(wall_time_s, 2) << " s"
+            << " (" << double_to_string(rendered_s / wall_time_s, 2) << "x real time, " << faults << " faults)\n";
+        return 0;
+    }
+};
@@ -0,0 +1,228 @@
+/* a log of every input that changes a running engine - file loads, throttle setpoints,
+ * prop commits (the starter is toggled by its prop) and graph edits - each stamped with
+ * the cycle it was applied before. inputs name nodes by tile, so a log replays onto a
+ * fresh engine loaded from the same files. one input per line:
+ *
+ *     cycle:command:x_tile:y_tile:tiles:value
+ *
+ * where tiles lists the selected nodes an edit applies to as x,y;x,y; and value is the
+ * rest of the line. the live frontend and the replay apply inputs through the same path,
+ * so a replay steps through the same states bit for bit */
+
+struct tile_t
+{
+    int x_tile = 0;
+    int y_tile = 0;
+};
+
+struct input_t
+{
+    int cycle = 0;
+    std::string command = "";
+    int x_tile = 0;
+    int y_tile = 0;
+    std::vector<tile_t> tiles;
+    std::string value = "";
+
+    std::string to_line() const
+    {
+        std::string line = std::to_string(cycle) + ":" + command + ":" + std::to_string(x_tile) + ":" + std::to_string(y_tile) + ":";
+        for(const tile_t& tile : tiles)
+        {
+            line += std::to_string(tile.x_tile) + "," + std::to_string(tile.y_tile) + ";";
+        }
+        return line + ":" + value;
+    }
+
+    static input_t from_line(const std::string& line)
+    {
+        std::vector<std::string> tokens;
+        size_t from = 0;
+        while(tokens.size() < 5)
+        {
+            size_t pos = line.find(':', from);
+            if(pos == std::string::npos)
+            {
+                throw std::invalid_argument("expected cycle:command:x_tile:y_tile:tiles:value, got: " + line);
+            }
+            tokens.push_back(line.substr(from, pos - from));
+            from = pos + 1;
+        }
+        input_t input;
+        input.cycle = std::stoi(tokens[0]);
+        input.command = tokens[1];
+        input.x_tile = std::stoi(tokens[2]);
+        input.y_tile = std::stoi(tokens[3]);
+        std::string tile = "";
+        std::stringstream stream{tokens[4]};
+        while(std::getline(stream, tile, ';'))
+        {
+            size_t pos = tile.find(',');
+            input.tiles.push_back({std::stoi(tile.substr(0, pos)), std::stoi(tile.substr(pos + 1))});
+        }
+        input.value = line.substr(from);
+        return input;
+    }
+};
+
+struct input_log_t
+{
+    std::vector<input_t> inputs;
+    std::ofstream file;
+
+    /* inputs are written as they are recorded, so a run that crashes still leaves its log */
+
+    void open(const std::string& filename)
+    {
+        file.open(filename);
+        if(file.is_open() == false)
+        {
+            throw std::runtime_error("could not open " + filename);
+        }
+    }
+
+    void record(const input_t& input)
+    {
+        inputs.push_back(input);
+        if(file.is_open())
+        {
+            file << input.to_line() << std::endl;
+        }
+    }
+
+    void load(const std::string& filename)
+    {
+        std::ifstream log_file{filename};
+        if(log_file.is_open() == false)
+        {
+            throw std::runtime_error("could not open " + filename);
+        }
+        std::string line = "";
+        while(std::getline(log_file, line))
+        {
+            if(line.empty() == false)
+            {
+                inputs.push_back(input_t::from_line(line));
+            }
+        }
+    }
+
+    /* a digest of the crank, exact to the bit, recorded when a run stops so a replay can tell if it diverged */
+
+    static std::string calc_digest(const engine_t& engine)
+    {
+        return double_to_exact_string(engine.crankshaft.theta_r) + "," + double_to_exact_string(engine.crankshaft.angular_velocity_r_per_s);
+    }
+
+    static void select_nodes_at(engine_t& engine, const std::vector<tile_t>& tiles)
+    {
+        engine.node_table.iterate(
+            [](node_t* node)
+            {
+                node->is_selected = false;
+            }
+        );
+        for(const tile_t& tile : tiles)
+        {
+            if(node_t* node = engine.node_table.get(tile.x_tile, tile.y_tile))
+            {
+                node->is_selected = true;
+            }
+        }
+    }
+
+    static void commit_prop(engine_t& engine, node_t* node, const std::string& key_value)
+    {
+        size_t pos = key_value.find('=');
+        if(pos == std::string::npos)
+        {
+            throw std::invalid_argument("expected key=value, got: " + key_value);
+        }
+        engine.commit_prop(node, std::string_view{key_value}.substr(0, pos), key_value.substr(pos + 1));
+    }
+
+    /* selection only matters to the plots, so it is not an input - edits carry the nodes they apply to */
+
+    static void apply(engine_t& engine, const input_t& input)
+    {
+        node_t* node = engine.node_table.get(input.x_tile, input.y_tile);
+        if(input.command == "load")
+        {
+            engine.load_nodes_from_disk(input.value);
+        }
+        else
+        if(input.command == "throttle")
+        {
+            engine.throttle_cable.pull_ratio_setpoint = std::stod(input.value);
+        }
+        else
+        if(input.command == "commit")
+        {
+            if(node)
+            {
+                commit_prop(engine, node, input.value);
+            }
+        }
+        else
+        if(input.command == "polymorph")
+        {
+            if(node)
+            {
+                engine.node_table.polymorph(node, engine.make_node(input.x_tile, input.y_tile, input.value));
+                engine.compile_schedule();
+            }
+        }
+        else
+        if(input.command == "make")
+        {
+            engine.node_table.create_node(input.x_tile, input.y_tile, engine.make_node(input.x_tile, input.y_tile, input.value));
+            engine.drivetrain.invalidate(); /* a piston turns with the crank before it is joined to the graph */
+        }
+        else
+        if(input.command == "join")
+        {
+            if(node)
+            {
+                select_nodes_at(engine, input.tiles);
+                engine.add_child_to_selected_nodes(node);
+            }
+        }
+        else
+        if(input.command == "move")
+        {
+            /* a move carries its offset in place of a tile */
+            select_nodes_at(engine, input.tiles);
+            engine.move_selected_nodes_by(input.x_tile, input.y_tile);
+        }
+        else
+        if(input.command == "root")
+        {
+            if(node)
+            {
+                engine.graph = node;
+                engine.compile_schedule();
+            }
+        }
+        else
+        if(input.command == "normalize")
+        {
+            select_nodes_at(engine, input.tiles);
+            engine.normalize_selected_nodes();
+        }
+        else
+        if(input.command == "delete")
+        {
+            select_nodes_at(engine, input.tiles);
+            engine.delete_selected_nodes();
+        }
+        else
+        if(input.command == "stop")
+        {
+            /* marks the end of a run */
+        }
+        else
+        {
+            throw std::invalid_argument("unknown input: " + input.command);
+        }
+    }
+};
@@ -0,0 +1,139 @@
+/* a timing wheel of gas mail - parcels always arrive within a short, bounded number
+ * of cycles (port length over flow velocity), so each is dropped into the slot for
+ * its arrival cycle and each read drains the slots that came due. inserts and reads
+ * are constant time with no comparisons. parcels that arrive beyond the horizon
+ * (long ports, slow flow) wait in an overflow list until they are within reach.
+ *
+ * parcels due on the same cycle are delivered in the order they were sent */
+
+template <typename parcel_t>
+struct mail_wheel_t
+{
+    static const int horizon = sim_n::mail_wheel_horizon_cycles;
+    static_assert((horizon & (horizon - 1)) == 0, "mail wheel horizon must be a power of two");
+    std::array<std::vector<parcel_t>, horizon> slots;
+    std::vector<parcel_t> overflow;
+    int next_cycle = 0; /* earliest cycle not yet drained */
+    int count = 0;
+
+    int size() const
+    {
+        return count;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
+
+    std::vector<parcel_t>& slot_at(int cycle)
+    {
+        return slots[cycle & (horizon - 1)];
+    }
+
+    void push(const parcel_t& parcel)
+    {
+        /* late mail is delivered on the next read */
+        int arrival_cycle = std::max(parcel.arrival_cycle, next_cycle);
+        if(arrival_cycle - next_cycle < horizon)
+        {
+            slot_at(arrival_cycle).push_back(parcel);
+        }
+        else
+        {
+            overflow.push_back(parcel);
+        }
+        count++;
+    }
+
+    int calc_earliest_overflow_cycle() const
+    {
+        int earliest_cycle = std::numeric_limits<int>::max();
+        for(const parcel_t& parcel : overflow)
+        {
+            earliest_cycle = std::min(earliest_cycle, parcel.arrival_cycle);
+        }
+        return earliest_cycle;
+    }
+
+    /* overflow parcels were sent before anything else bound for their slot,
+     * so they are moved in as soon as the slot comes within reach */
+    void reach_overflow()
+    {
+        if(overflow.empty())
+        {
+            return;
+        }
+        std::vector<parcel_t> waiting;
+        for(const parcel_t& parcel : overflow)
+        {
+            if(parcel.arrival_cycle - next_cycle < horizon)
+            {
+                slot_at(std::max(parcel.arrival_cycle, next_cycle)).push_back(parcel);
+            }
+            else
+            {
+                waiting.push_back(parcel);
+            }
+        }
+        overflow = std::move(waiting);
+    }
+
+    /* every parcel in delivery order - assigning them back rebuilds the same wheel */
+
+    std::vector<parcel_t> calc_parcels() const
+    {
+        std::vector<parcel_t> parcels;
+        parcels.reserve(count);
+        for(int cycle = next_cycle; cycle < next_cycle + horizon; cycle++)
+        {
+            const std::vector<parcel_t>& slot = slots[cycle & (horizon - 1)];
+            parcels.insert(parcels.end(), slot.begin(), slot.end());
+        }
+        parcels.insert(parcels.end(), overflow.begin(), overflow.end());
+        return parcels;
+    }
+
+    void assign(int cycle, const std::vector<parcel_t>& parcels)
+    {
+        for(std::vector<parcel_t>& slot : slots)
+        {
+            slot.clear();
+        }
+        overflow.clear();
+        next_cycle = cycle;
+        count = 0;
+        for(const parcel_t& parcel : parcels)
+        {
+            push(parcel);
+        }
+    }
+
+    template <typename handle_t>
+    void drain(int cycle, handle_t handle)
+    {
+        while(next_cycle <= cycle)
+        {
+            int slotted = count - overflow.size();
+            if(slotted == 0)
+            {
+                /* nothing in the wheel - skip straight to the earliest overflow arrival */
+                next_cycle = std::min(cycle + 1, std::max(next_cycle, calc_earliest_overflow_cycle()));
+                if(next_cycle > cycle)
+                {
+                    break;
+                }
+            }
+            reach_overflow();
+            std::vector<parcel_t>& slot = slot_at(next_cycle);
+            for(const parcel_t& parcel : slot)
+            {
+                handle(parcel);
+            }
+            count -= slot.size();
+            slot.clear();
+            next_cycle++;
+        }
+        reach_overflow();
+    }
+};
@@ -7,6 +7,7 @@
 #include "colo_t.hh"
 #include "expression_parser_t.hh"
 #include "prop_t.hh"
+#include "prop_graph_t.hh"
 #include "render_t.hh"
 #include "plot_t.hh"
 #include "observerable_t.hh"
@@ -16,15 +17,94 @@
 #include "starter_motor_t.hh"
 #include "port_t.hh"
 #include "filter_t.hh"
+#include "ring_t.hh"
+#include "gas_store_t.hh"
 #include "gas_t.hh"
+#include "mail_wheel_t.hh"
 #include "flame_t.hh"
 #include "audio_processor_t.hh"
 #include "volume_t.hh"
+#include "drivetrain_t.hh"
 #include "node_t.hh"
+#include "worker_pool_t.hh"
+#include "schedule_t.hh"
+#include "engine_t.hh"
+#include "input_log_t.hh"
+#include "checkpoint_t.hh"
+#include "pcm_writer_t.hh"
+#include "headless_t.hh"
+#include "steady_state_detector_t.hh"
+#include "warm_start_cache_t.hh"
+#include "batch_t.hh"
+#include "dyno_t.hh"
+#include "ensemble_t.hh"
+#include "host_t.hh"
+#include "replay_t.hh"
 #include "sdl_t.hh"
 #include "ensim_t.hh"
 
-int main()
+int main(int argc, char* argv[])
 {
-    ensim_t{}.run();
+    std::vector<std::string> args{argv + 1, argv + argc};
+    if(std::find(args.begin(), args.end(), "--headless") not_eq args.end())
+    {
+        try
+        {
+            return headless_t{args}.run();
+        }
+        catch(const std::exception& exception)
+        {
+            std::cerr << exception.what() << "\n";
+            return 1;
+        }
+    }
+    if(std::find(args.begin(), args.end(), "--dyno") not_eq args.end())
+    {
+        try
+        {
+            return dyno_t{args}.run();
+        }
+        catch(const std::exception& exception)
+        {
+            std::cerr << exception.what() << "\n";
+            return 1;
+        }
+    }
+    if(std::find(args.begin(), args.end(), "--ensemble") not_eq args.end())
+    {
+        try
+        {
+            return ensemble_t{args}.run();
+        }
+        catch(const std::exception& exception)
+        {
+            std::cerr << exception.what() << "\n";
+            return 1;
+        }
+    }
+    if(std::find(args.begin(), args.end(), "--host") not_eq args.end())
+    {
+        try
+        {
+            return host_cli_t{args}.run();
+        }
+        catch(const std::exception& exception)
+        {
+            std::cerr << exception.what() << "\n";
+            return 1;
+        }
+    }
+    if(std::find(args.begin(), args.end(), "--replay") not_eq args.end())
+    {
+        try
+        {
+            return replay_t{args}.run();
+        }
+        catch(const std::exception& exception)
+        {
+            std::cerr << exception.what() << "\n";
+            return 1;
+        }
+    }
+    ensim_t{args}.run();
 }
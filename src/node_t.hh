@@ -5,17 +5,17 @@ struct node_t
     std::unique_ptr<volume_t> volume = nullptr;
     std::unique_ptr<port_t> port = nullptr;
     std::vector<node_t*> children;
-    prop_table_t prop_table;
+    prop_formulas_t formulas;
     bool is_selected = false;
     bool was_moved = false;
     double work_time_ns = 0.0;
+    std::vector<double> plot_datum;
 
     node_t(int x_tile, int y_tile, std::unique_ptr<volume_t>&& volume, std::unique_ptr<port_t>&& port)
         : x_tile{x_tile}
         , y_tile{y_tile}
         , volume{std::move(volume)}
         , port{std::move(port)}
-        , prop_table{this->port->get_prop_table() + this->volume->get_prop_table()}
         {
         }
 
@@ -23,7 +23,7 @@ struct node_t
     {
         volume = std::move(other->volume);
         port = std::move(other->port);
-        prop_table = std::move(other->prop_table);
+        formulas = std::move(other->formulas);
     }
 
     void add_child(node_t* child)
@@ -57,28 +57,19 @@ struct node_t
         {
             node_t* parent = queue.front();
             queue.pop();
-            auto t0 = std::chrono::high_resolution_clock::now();
-            bool is_done = handle_node(parent);
-            auto t1 = std::chrono::high_resolution_clock::now();
-            if(is_done)
+            if(handle_node(parent))
             {
                 break;
             }
             for(node_t* child : parent->children)
             {
-                auto t2 = std::chrono::high_resolution_clock::now();
                 handle_edge(parent, child);
-                auto t3 = std::chrono::high_resolution_clock::now();
-                auto work_time_edge_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count();
-                parent->port->work_time_ns += work_time_edge_ns;
                 if(visited.contains(child) == false)
                 {
                     queue.push(child);
                     visited.insert(child);
                 }
             }
-            auto work_time_parent_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
-            parent->work_time_ns += work_time_parent_ns;
         }
     }
 
@@ -117,7 +108,6 @@ struct node_table_t
     int y_tiles = 0;
     std::vector<piston_t*>& pistons;
     std::vector<injector_t*>& injectors;
-    std::vector<rotational_mass_t*>& rotational_masses;
     std::vector<throttle_port_t*>& throttle_ports;
 
     node_table_t(
@@ -125,13 +115,11 @@ struct node_table_t
         int y_tiles,
         std::vector<piston_t*>& pistons,
         std::vector<injector_t*>& injectors,
-        std::vector<rotational_mass_t*>& rotational_masses,
         std::vector<throttle_port_t*>& throttle_ports)
             : x_tiles{x_tiles}
             , y_tiles{y_tiles}
             , pistons{pistons}
             , injectors{injectors}
-            , rotational_masses{rotational_masses}
             , throttle_ports{throttle_ports}
             {
                 nodes.resize(x_tiles * y_tiles);
@@ -141,7 +129,6 @@ struct node_table_t
     {
         node->volume->on_delete(pistons);
         node->volume->on_delete(injectors);
-        node->volume->on_delete(rotational_masses);
         node->port->on_delete(throttle_ports);
     }
 
@@ -149,7 +136,6 @@ struct node_table_t
     {
         node->volume->on_create(pistons);
         node->volume->on_create(injectors);
-        node->volume->on_create(rotational_masses);
         node->port->on_create(throttle_ports);
     }
 
@@ -1,5 +1,4 @@
 struct piston_t;
-struct rotational_mass_t;
 struct throttle_port_t;
 struct injector_t;
 
@@ -19,8 +18,6 @@ struct observable_t
 
     virtual void on_create(std::vector<piston_t*>&) {}
     virtual void on_delete(std::vector<piston_t*>&) {}
-    virtual void on_create(std::vector<rotational_mass_t*>&) {}
-    virtual void on_delete(std::vector<rotational_mass_t*>&) {}
     virtual void on_create(std::vector<throttle_port_t*>&) {}
     virtual void on_delete(std::vector<throttle_port_t*>&) {}
     virtual void on_create(std::vector<injector_t*>&) {}
@@ -1,16 +1,28 @@
 #include <unordered_set>
 #include <variant>
+#include <optional>
 #include <memory>
 #include <memory_resource>
 #include <queue>
+#include <deque>
 #include <algorithm>
 #include <string>
+#include <string_view>
+#include <iterator>
 #include <functional>
 #include <sstream>
+#include <charconv>
 #include <iomanip>
 #include <fstream>
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <type_traits>
 #include <cassert>
+#include <cstring>
+#include <cstdint>
 #include <SDL2/SDL.h>
@@ -0,0 +1,105 @@
+/* streams mono 32 bit float samples as a wav file, or as headerless
+ * raw pcm when the filename does not end in .wav ("-" is stdout) */
+
+struct pcm_writer_t
+{
+    std::ofstream file;
+    std::ostream* stream = nullptr;
+    bool is_wav = false;
+    uint32_t samples = 0;
+
+    pcm_writer_t(const std::string& filename)
+    {
+        if(filename == "-")
+        {
+            stream = &std::cout;
+        }
+        else
+        {
+            file.open(filename, std::ios::binary);
+            if(file.is_open() == false)
+            {
+                throw std::runtime_error("could not open " + filename + " for writing");
+            }
+            stream = &file;
+            is_wav = filename.ends_with(".wav");
+        }
+        if(is_wav)
+        {
+            write_wav_header();
+        }
+    }
+
+    ~pcm_writer_t()
+    {
+        if(is_wav)
+        {
+            file.seekp(0);
+            write_wav_header();
+        }
+        stream->flush();
+    }
+
+    void write_u16(uint16_t value)
+    {
+        char bytes[] = {
+            static_cast<char>(value >> 0),
+            static_cast<char>(value >> 8),
+        };
+        stream->write(bytes, sizeof(bytes));
+    }
+
+    void write_u32(uint32_t value)
+    {
+        char bytes[] = {
+            static_cast<char>(value >> 0),
+            static_cast<char>(value >> 8),
+            static_cast<char>(value >> 16),
+            static_cast<char>(value >> 24),
+        };
+        stream->write(bytes, sizeof(bytes));
+    }
+
+    /* sizes are unknown until the stream closes - the header is written
+     * once up front as a placeholder and then patched in the destructor */
+
+    void write_wav_header()
+    {
+        uint16_t ieee_float_format = 3;
+        uint16_t channels = 1;
+        uint16_t bits_per_sample = 8 * sizeof(float);
+        uint32_t sample_rate_hz = sim_n::sample_frequency_hz;
+        uint32_t block_align = channels * sizeof(float);
+        uint32_t data_bytes = samples * block_align;
+        stream->write("RIFF", 4);
+        write_u32(36 + data_bytes);
+        stream->write("WAVE", 4);
+        stream->write("fmt ", 4);
+        write_u32(16);
+        write_u16(ieee_float_format);
+        write_u16(channels);
+        write_u32(sample_rate_hz);
+        write_u32(sample_rate_hz * block_align);
+        write_u16(block_align);
+        write_u16(bits_per_sample);
+        stream->write("data", 4);
+        write_u32(data_bytes);
+    }
+
+    void write(const std::vector<float>& buffer)
+    {
+        std::vector<char> bytes(buffer.size() * sizeof(float));
+        int size = buffer.size();
+        for(int i = 0; i < size; i++)
+        {
+            uint32_t bits = 0;
+            std::memcpy(&bits, &buffer[i], sizeof(bits));
+            for(int byte = 0; byte < 4; byte++)
+            {
+                bytes[4 * i + byte] = static_cast<char>(bits >> (8 * byte));
+            }
+        }
+        stream->write(bytes.data(), bytes.size());
+        samples += size;
+    }
+};
@@ -136,7 +136,14 @@ struct plot_panel_t
         plot_t{5, 15, "rad", "", "audio signal"},
     };
 
+    plot_panel_t() = default;
+
     plot_panel_t(int x_p, int yres_p, int w_p)
+    {
+        layout(x_p, yres_p, w_p);
+    }
+
+    void layout(int x_p, int yres_p, int w_p)
     {
         int y_p = 0;
         int h_p = yres_p / panel.size();
@@ -0,0 +1,222 @@
+/* every prop bound to an expression, across every node and the engine - a prop is bound when
+ * it is live or when its expression reads other props. props are known by the double they
+ * write, and node props reading engine props is what links the nodes. the graph is put in
+ * dependency order when it is linked, and a commit then evaluates only the props downstream
+ * of the double it changed, each after everything it reads. live props and the props
+ * downstream of them are evaluated every cycle */
+
+struct node_t;
+
+struct bound_prop_t
+{
+    prop_formulas_t* formulas = nullptr; /* where the expression is kept, so the prop can be unbound */
+    node_t* node = nullptr; /* whose gas the prop may write, null for engine props */
+    std::string_view key = "";
+    bool is_live = false;
+    double* real = nullptr;
+    expression_t expression;
+    int rank = 0; /* position in dependency order */
+};
+
+struct prop_graph_t
+{
+    std::vector<bound_prop_t> bound_props;
+    std::unordered_map<const double*, int> bound_index;
+    std::unordered_map<const double*, std::vector<int>> readers; /* the bound props that read each double */
+    std::vector<int> order;
+    std::vector<int> cycle_order; /* live props and the props downstream of them */
+    std::vector<node_t*> cycle_nodes; /* the nodes the cycle writes - their gas must be invalidated after */
+
+    void clear()
+    {
+        bound_props.clear();
+        bound_index.clear();
+        readers.clear();
+        order.clear();
+        cycle_order.clear();
+        cycle_nodes.clear();
+    }
+
+    bool contains(const double* real) const
+    {
+        return bound_index.contains(real);
+    }
+
+    void add(prop_formulas_t* formulas, node_t* node, const prop_t& prop, expression_t&& expression)
+    {
+        double* real = std::get<double*>(prop.real);
+        bound_index[real] = bound_props.size();
+        bound_props.push_back({formulas, node, prop.key, prop.is_live, real, std::move(expression)});
+    }
+
+    /* does the expression read the double, directly or through the bound props it reads */
+
+    bool reads(const expression_t& expression, const double* real) const
+    {
+        std::vector<const double*> stack = expression.get_slots();
+        std::unordered_set<const double*> visited;
+        while(stack.empty() == false)
+        {
+            const double* slot = stack.back();
+            stack.pop_back();
+            if(slot == real)
+            {
+                return true;
+            }
+            auto at = bound_index.find(slot);
+            if(at not_eq bound_index.end() and visited.insert(slot).second)
+            {
+                std::vector<const double*> slots = bound_props[at->second].expression.get_slots();
+                stack.insert(stack.end(), slots.begin(), slots.end());
+            }
+        }
+        return false;
+    }
+
+    void collect_downstream(const double* real, std::vector<int>& affected, std::vector<bool>& is_affected) const
+    {
+        std::vector<const double*> stack = {real};
+        while(stack.empty() == false)
+        {
+            auto at = readers.find(stack.back());
+            stack.pop_back();
+            if(at == readers.end())
+            {
+                continue;
+            }
+            for(int reader : at->second)
+            {
+                if(is_affected[reader] == false)
+                {
+                    is_affected[reader] = true;
+                    affected.push_back(reader);
+                    stack.push_back(bound_props[reader].real);
+                }
+            }
+        }
+    }
+
+    void sort_by_rank(std::vector<int>& indices) const
+    {
+        std::sort(
+            indices.begin(), indices.end(),
+            [this](int a, int b)
+            {
+                return bound_props[a].rank < bound_props[b].rank;
+            }
+        );
+    }
+
+    /* orders the props so each comes after the props it reads. props that read each other in
+     * a cycle cannot be ordered - they are returned, and the graph must be bound again without them */
+
+    std::vector<int> link()
+    {
+        int size = bound_props.size();
+        std::vector<int> in_degree(size, 0);
+        readers.clear();
+        for(int index = 0; index < size; index++)
+        {
+            for(const double* slot : bound_props[index].expression.get_slots())
+            {
+                readers[slot].push_back(index);
+                if(contains(slot))
+                {
+                    in_degree[index]++;
+                }
+            }
+        }
+        order.clear();
+        for(int index = 0; index < size; index++)
+        {
+            if(in_degree[index] == 0)
+            {
+                order.push_back(index);
+            }
+        }
+        for(size_t at = 0; at < order.size(); at++)
+        {
+            bound_props[order[at]].rank = at;
+            auto reader = readers.find(bound_props[order[at]].real);
+            if(reader not_eq readers.end())
+            {
+                for(int index : reader->second)
+                {
+                    if(--in_degree[index] == 0)
+                    {
+                        order.push_back(index);
+                    }
+                }
+            }
+        }
+        std::vector<int> cyclic;
+        if(static_cast<int>(order.size()) < size)
+        {
+            /* what is left is in a cycle or downstream of one - only the former are unbound */
+            for(int index = 0; index < size; index++)
+            {
+                if(in_degree[index] > 0 and reads(bound_props[index].expression, bound_props[index].real))
+                {
+                    cyclic.push_back(index);
+                }
+            }
+            return cyclic;
+        }
+        cycle_order.clear();
+        std::vector<bool> is_downstream(size, false);
+        for(int index = 0; index < size; index++)
+        {
+            if(bound_props[index].is_live and is_downstream[index] == false)
+            {
+                is_downstream[index] = true;
+                cycle_order.push_back(index);
+                collect_downstream(bound_props[index].real, cycle_order, is_downstream);
+            }
+        }
+        sort_by_rank(cycle_order);
+        cycle_nodes.clear();
+        for(int index : cycle_order)
+        {
+            node_t* node = bound_props[index].node;
+            if(node and std::find(cycle_nodes.begin(), cycle_nodes.end(), node) == cycle_nodes.end())
+            {
+                cycle_nodes.push_back(node);
+            }
+        }
+        return cyclic;
+    }
+
+    void eval(int index)
+    {
+        bound_prop_t& bound_prop = bound_props[index];
+        *bound_prop.real = bound_prop.expression.eval();
+    }
+
+    void update(const double* real)
+    {
+        std::vector<int> affected;
+        std::vector<bool> is_affected(bound_props.size(), false);
+        collect_downstream(real, affected, is_affected);
+        sort_by_rank(affected);
+        for(int index : affected)
+        {
+            eval(index);
+        }
+    }
+
+    void update_all()
+    {
+        for(int index : order)
+        {
+            eval(index);
+        }
+    }
+
+    void run_cycle()
+    {
+        for(int index : cycle_order)
+        {
+            eval(index);
+        }
+    }
+};
@@ -1,22 +1,100 @@
+/* a double prop committed as an expression of other props is bound to it, and is evaluated
+ * again whenever a prop it reads is committed - a port committed as volume_diameter_m/4
+ * follows its volume. a prop committed as =expression is live, and is evaluated again every
+ * cycle - committing
+ *
+ *     =2*pi - crankshaft_angular_velocity_r_per_s/1000
+ *
+ * to sparkplug_engage_r advances the spark as the crank speeds up. the engine keeps both in
+ * a prop graph. anything else is evaluated once */
+
 struct prop_t
 {
     using real_t = std::variant<double*, int*, bool*, std::string*>;
-    std::string key = "";
-    std::string value = "";
+    using resolve_t = std::function<const double*(std::string_view)>;
+    std::string_view key = ""; /* always a string literal, so tables share keys rather than copy them */
+    std::string value = ""; /* the text shown and saved - formatted on demand by sync */
     real_t real;
+    bool is_synced = false;
+    uint64_t synced_bits = 0; /* the backing value the text was last formatted from */
+    std::string formula = ""; /* the expression of a bound prop, empty otherwise */
+    bool is_live = false;
 
-    prop_t(const std::string& key, const real_t& real)
+    prop_t(std::string_view key, const real_t& real)
         : key{key}
         , real{real}
         {
-            sync();
         }
 
+    uint64_t calc_real_bits() const
+    {
+        if(std::holds_alternative<double*>(real))
+        {
+            return std::bit_cast<uint64_t>(*std::get<double*>(real));
+        }
+        else
+        if(std::holds_alternative<int*>(real))
+        {
+            return *std::get<int*>(real);
+        }
+        else
+        if(std::holds_alternative<bool*>(real))
+        {
+            return *std::get<bool*>(real);
+        }
+        return 0;
+    }
+
+    bool is_bound() const
+    {
+        return formula.empty() == false;
+    }
+
+    void unbind()
+    {
+        formula.clear();
+        is_live = false;
+        is_synced = false;
+    }
+
+    /* the expression as committed - live expressions keep their leading = */
+
+    std::string get_formula_text() const
+    {
+        return is_live ? "=" + formula : formula;
+    }
+
+    void set_formula_text(std::string_view text)
+    {
+        is_live = text.starts_with('=');
+        formula = is_live ? text.substr(1) : text;
+        is_synced = false;
+    }
+
+    /* formatting is the expensive part of drawing a table, so text is only formatted
+     * when the backing value moved since it was last formatted */
+
     void sync()
     {
+        if(is_bound())
+        {
+            value = get_formula_text();
+            return;
+        }
+        if(std::holds_alternative<std::string*>(real))
+        {
+            value = *std::get<std::string*>(real);
+            return;
+        }
+        uint64_t bits = calc_real_bits();
+        if(is_synced and bits == synced_bits)
+        {
+            return;
+        }
+        is_synced = true;
+        synced_bits = bits;
         if(std::holds_alternative<double*>(real))
         {
-            std::ostringstream stream;
             double double_value = *std::get<double*>(real);
             double precision = double_value == 0.0 ? 1 : ui_n::prop_table_double_precision;
             value = double_to_string(double_value, precision);
@@ -31,24 +109,27 @@ struct prop_t
         {
             value = *std::get<bool*>(real) ? "true" : "false";
         }
-        else
-        if(std::holds_alternative<std::string*>(real))
-        {
-            value = *std::get<std::string*>(real);
-        }
     }
 
-    void commit(std::function<double(std::string)> lookup = nullptr)
+    void commit(const resolve_t& resolve = nullptr)
     {
+        unbind();
         if(std::holds_alternative<double*>(real))
         {
-            expression_parser_t parser{lookup};
-            *std::get<double*>(real) = parser.parse(value);
+            is_live = value.starts_with('=');
+            std::string text = is_live ? value.substr(1) : value;
+            expression_parser_t parser{resolve};
+            expression_t expression = parser.compile(text);
+            *std::get<double*>(real) = expression.eval();
+            if(is_live or expression.reads_props())
+            {
+                formula = text;
+            }
         }
         else
         if(std::holds_alternative<int*>(real))
         {
-            expression_parser_t parser{lookup};
+            expression_parser_t parser{resolve};
             *std::get<int*>(real) = parser.parse(value);
         }
         else
@@ -69,13 +150,55 @@ struct prop_t
         {
             *std::get<std::string*>(real) = value;
         }
+        is_synced = false; /* the typed text is replaced even when it evaluates to the old value */
         sync();
     }
+
+    /* for loading - plain numbers are read directly. double expressions are left for the engine
+     * to bind once every table is loaded, as the props they read may not be loaded yet */
+
+    void assign(std::string_view text)
+    {
+        value = text;
+        unbind();
+        const char* first = text.data();
+        const char* last = text.data() + text.size();
+        if(std::holds_alternative<double*>(real))
+        {
+            double double_value = 0.0;
+            std::from_chars_result result = std::from_chars(first, last, double_value, std::chars_format::fixed);
+            if(result.ec == std::errc{} and result.ptr == last)
+            {
+                *std::get<double*>(real) = double_value;
+                return;
+            }
+            set_formula_text(text);
+            expression_parser_t parser{nullptr};
+            *std::get<double*>(real) = parser.parse(formula);
+            return;
+        }
+        else
+        if(std::holds_alternative<int*>(real))
+        {
+            int int_value = 0;
+            std::from_chars_result result = std::from_chars(first, last, int_value);
+            if(result.ec == std::errc{} and result.ptr == last)
+            {
+                *std::get<int*>(real) = int_value;
+                return;
+            }
+        }
+        commit();
+    }
 };
 
+/* lookups go through an open addressed index of key hashes, built on the first lookup
+ * after the table is put together - tables are only ever built by concatenation */
+
 struct prop_table_t
 {
     std::vector<prop_t> table;
+    std::vector<int> index; /* one past the table index of each key, zero when empty */
 
     prop_table_t() = default;
 
@@ -95,29 +218,74 @@ struct prop_table_t
         return &table[index];
     }
 
-    std::optional<prop_t::real_t> find(const std::string& key)
+    /* keys are long and share prefixes and suffixes - their length and middle and last eight
+     * characters tell them apart without reading every character */
+
+    static size_t calc_key_hash(std::string_view key)
     {
-        for(prop_t& prop : table)
+        size_t size = key.size();
+        if(size < 8)
         {
-            if(prop.key == key)
+            size_t hash = size;
+            for(char c : key)
             {
-                return prop.real;
+                hash = hash * 31 + static_cast<unsigned char>(c);
             }
+            return hash * 0x9e3779b97f4a7c15ull >> 32;
         }
-        return std::nullopt;
+        uint64_t middle = 0;
+        uint64_t tail = 0;
+        std::memcpy(&middle, key.data() + (size - 8) / 2, 8);
+        std::memcpy(&tail, key.data() + size - 8, 8);
+        return (middle ^ std::rotl(tail, 29) ^ size) * 0x9e3779b97f4a7c15ull >> 32;
     }
 
-    void set_prop(const std::string& key, const std::string& value)
+    void build_index()
     {
-        for(prop_t& prop : table)
+        int capacity = std::bit_ceil(2 * table.size() + 1);
+        index.assign(capacity, 0);
+        int size = table.size();
+        for(int at = 0; at < size; at++)
+        {
+            size_t slot = calc_key_hash(table[at].key) & (capacity - 1);
+            while(index[slot] not_eq 0)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            index[slot] = at + 1;
+        }
+    }
+
+    prop_t* get(std::string_view key)
+    {
+        if(index.empty())
         {
+            build_index();
+        }
+        size_t mask = index.size() - 1;
+        for(size_t slot = calc_key_hash(key) & mask; index[slot] not_eq 0; slot = (slot + 1) & mask)
+        {
+            prop_t& prop = table[index[slot] - 1];
             if(prop.key == key)
             {
-                prop.value = value;
-                prop.commit();
-                break;
+                return &prop;
+            }
+        }
+        return nullptr;
+    }
+
+    /* the double behind a key, for compiling expressions against the table */
+
+    const double* get_double(std::string_view key)
+    {
+        if(prop_t* prop = get(key))
+        {
+            if(std::holds_alternative<double*>(prop->real))
+            {
+                return std::get<double*>(prop->real);
             }
         }
+        return nullptr;
     }
 
     void sync()
@@ -143,15 +311,23 @@ struct prop_table_t
         );
     }
 
-    prop_table_t operator+(const prop_table_t& other)
-    {
-        prop_table_t sum;
-        sum.table.insert(sum.table.end(), table.begin(), table.end());
-        sum.table.insert(sum.table.end(), other.table.begin(), other.table.end());
-        return sum;
-    }
 };
 
+/* tables are mostly put together from temporaries, which are moved across rather than copied */
+
+prop_table_t operator+(prop_table_t lhs, prop_table_t rhs)
+{
+    prop_table_t sum;
+    sum.table = std::move(lhs.table);
+    sum.table.insert(sum.table.end(), std::make_move_iterator(rhs.table.begin()), std::make_move_iterator(rhs.table.end()));
+    return sum;
+}
+
+/* nodes keep no prop tables - tables are made from a node's parts when they are shown, edited
+ * or saved, so all a node keeps of its props are the expressions of those that are bound, by key */
+
+using prop_formulas_t = std::unordered_map<std::string_view, std::string>;
+
 struct has_prop_table_t
 {
     virtual prop_table_t get_prop_table() = 0;
@@ -0,0 +1,116 @@
+/* ensim3 --replay log [--threads n] [--out file.wav|file.pcm|-]
+ *
+ * replays a log recorded with ensim3 --record log without initializing sdl - each input
+ * is applied before the cycle it was stamped with, and the run ends where the recording
+ * stopped. the engine files the log loads must not have changed since it was recorded.
+ * when the recording stopped cleanly the crank is checked against the digest it left */
+
+struct replay_t
+{
+    std::string filename = "";
+    std::string out_filename = "";
+    input_log_t input_log;
+    engine_t engine;
+
+    replay_t(const std::vector<std::string>& args)
+    {
+        int size = args.size();
+        for(int i = 0; i < size; i++)
+        {
+            const std::string& arg = args[i];
+            bool has_value = i + 1 < size;
+            if(arg == "--replay" and has_value)
+            {
+                filename = args[++i];
+            }
+            else
+            if(arg == "--threads" and has_value)
+            {
+                engine.max_worker_threads = std::stoi(args[++i]);
+            }
+            else
+            if(arg == "--out" and has_value)
+            {
+                out_filename = args[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("unknown or incomplete argument: " + arg);
+            }
+        }
+        input_log.load(filename);
+        if(input_log.inputs.empty())
+        {
+            throw std::invalid_argument(filename + " holds no inputs");
+        }
+    }
+
+    int run()
+    {
+        std::unique_ptr<pcm_writer_t> writer;
+        if(out_filename.empty() == false)
+        {
+            writer = std::make_unique<pcm_writer_t>(out_filename);
+        }
+        std::vector<float>& buffer = engine.audio_processor.buffer;
+        const std::vector<input_t>& inputs = input_log.inputs;
+        int size = inputs.size();
+        int next_input = 0;
+        int faults = 0;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        while(true)
+        {
+            while(next_input < size and inputs[next_input].cycle <= engine.cycle and inputs[next_input].command not_eq "stop")
+            {
+                input_log_t::apply(engine, inputs[next_input++]);
+            }
+            if(next_input == size or inputs[next_input].cycle <= engine.cycle)
+            {
+                break;
+            }
+            if(engine.graph == nullptr)
+            {
+                throw std::runtime_error("replay of " + filename + " did not load an engine");
+            }
+            try
+            {
+                engine.run_sim_once();
+            }
+            catch(const std::exception&)
+            {
+                engine.normalize_all_nodes();
+                faults++;
+            }
+            int buffered = buffer.size();
+            if(buffered >= sim_n::cycles_per_frame)
+            {
+                if(writer)
+                {
+                    writer->write(buffer);
+                }
+                buffer.clear();
+            }
+        }
+        if(writer)
+        {
+            writer->write(buffer);
+        }
+        buffer.clear();
+        auto t1 = std::chrono::high_resolution_clock::now();
+        double wall_time_s = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / 1e9;
+        std::cerr
+            << "replayed " << size << " inputs over " << engine.cycle << " cycles of " << filename
+            << " in " << double_to_string(wall_time_s, 2) << " s (" << faults << " faults)\n";
+        if(next_input < size and inputs[next_input].command == "stop")
+        {
+            std::string digest = input_log_t::calc_digest(engine);
+            if(digest not_eq inputs[next_input].value)
+            {
+                std::cerr << "diverged from the recording: " << digest << " but recorded " << inputs[next_input].value << "\n";
+                return 1;
+            }
+            std::cerr << "matched the recording: " << digest << "\n";
+        }
+        return 0;
+    }
+};
@@ -0,0 +1,43 @@
+/* single producer single consumer lock free ring - one thread pushes, another
+ * pops, and neither ever blocks. capacity must be a power of two so that the
+ * free running head and tail counters wrap with a mask */
+
+template <typename T, int capacity>
+struct ring_t
+{
+    static_assert((capacity & (capacity - 1)) == 0, "ring capacity must be a power of two");
+    std::array<T, capacity> buffer = {};
+    std::atomic<uint32_t> head = 0; /* advanced by the consumer */
+    std::atomic<uint32_t> tail = 0; /* advanced by the producer */
+
+    int size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    int push(const T* values, int count)
+    {
+        uint32_t at = tail.load(std::memory_order_relaxed);
+        int free = capacity - (at - head.load(std::memory_order_acquire));
+        count = std::min(count, free);
+        for(int i = 0; i < count; i++)
+        {
+            buffer[(at + i) & (capacity - 1)] = values[i];
+        }
+        tail.store(at + count, std::memory_order_release);
+        return count;
+    }
+
+    int pop(T* values, int count)
+    {
+        uint32_t at = head.load(std::memory_order_relaxed);
+        int used = tail.load(std::memory_order_acquire) - at;
+        count = std::min(count, used);
+        for(int i = 0; i < count; i++)
+        {
+            values[i] = buffer[(at + i) & (capacity - 1)];
+        }
+        head.store(at + count, std::memory_order_release);
+        return count;
+    }
+};
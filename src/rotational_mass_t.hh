@@ -31,11 +31,11 @@ struct crankshaft_t
         return prop_table;
     }
 
-    void accelerate(double angular_acceleration_r_per_s)
+    void accelerate(double angular_acceleration_r_per_s, double dt_s)
     {
-        angular_velocity_r_per_s += angular_acceleration_r_per_s * sim_n::dt_s;
+        angular_velocity_r_per_s += angular_acceleration_r_per_s * dt_s;
         last_theta_r = theta_r;
-        theta_r += angular_velocity_r_per_s * sim_n::dt_s;
+        theta_r += angular_velocity_r_per_s * dt_s;
     }
 
     bool finished_rotation()
@@ -0,0 +1,265 @@
+/* the breadth first walk of node_t::iterate flattened once per graph change -
+ * nodes are stored in visit order, and each node owns a contiguous range of
+ * edges in child order, so executing the schedule visits exactly what the
+ * breadth first search would have visited */
+
+struct schedule_edge_t
+{
+    int parent = 0;
+    int child = 0;
+    port_t* port = nullptr;
+};
+
+/* off costs nothing, sampled times one step in profile_sample_period, full times every step */
+
+enum class profile_mode_t
+{
+    off, sampled, full
+};
+
+struct schedule_t
+{
+    std::vector<node_t*> nodes;
+    std::vector<schedule_edge_t> edges;
+    std::vector<int> edge_offsets;
+    std::vector<int> trunk;
+    std::vector<std::vector<int>> branches;
+    worker_pool_t workers;
+    profile_mode_t profile_mode = profile_mode_t::off;
+    int profile_sample_period = sim_n::profile_sample_period;
+    int profile_tick = 0;
+
+    void clear()
+    {
+        nodes.clear();
+        edges.clear();
+        edge_offsets.clear();
+        trunk.clear();
+        branches.clear();
+    }
+
+    void compile(node_t* graph)
+    {
+        clear();
+        if(graph == nullptr)
+        {
+            return;
+        }
+        std::unordered_map<node_t*, int> node_to_index;
+        graph->iterate(
+            [this, &node_to_index](node_t* parent)
+            {
+                node_to_index[parent] = nodes.size();
+                nodes.push_back(parent);
+                return false;
+            }
+        );
+        for(node_t* parent : nodes)
+        {
+            edge_offsets.push_back(edges.size());
+            for(node_t* child : parent->children)
+            {
+                edges.push_back({node_to_index[parent], node_to_index[child], parent->port.get()});
+            }
+        }
+        edge_offsets.push_back(edges.size());
+        compile_branches();
+    }
+
+    /* a branch is a chain hanging off a fan out node where every node has exactly one
+     * parent (like an injector feeding a piston) - it ends at a join, like the collector,
+     * or at a node whose work reaches into other nodes. branches touch nothing but their
+     * own nodes while doing node work so they can run side by side. the rest is trunk */
+
+    void compile_branches()
+    {
+        int size = nodes.size();
+        std::vector<int> in_degrees(size, 0);
+        for(const schedule_edge_t& record : edges)
+        {
+            in_degrees[record.child]++;
+        }
+        std::vector<bool> is_branched(size, false);
+        for(int index = 0; index < size; index++)
+        {
+            int child_count = edge_offsets[index + 1] - edge_offsets[index];
+            if(child_count < 2)
+            {
+                continue;
+            }
+            for(int edge = edge_offsets[index]; edge < edge_offsets[index + 1]; edge++)
+            {
+                std::vector<int> branch;
+                int at = edges[edge].child;
+                while(in_degrees[at] == 1 and not is_branched[at] and nodes[at]->volume->is_parallel_safe())
+                {
+                    branch.push_back(at);
+                    is_branched[at] = true;
+                    if(edge_offsets[at + 1] - edge_offsets[at] not_eq 1)
+                    {
+                        break;
+                    }
+                    at = edges[edge_offsets[at]].child;
+                }
+                if(branch.empty() == false)
+                {
+                    branches.push_back(branch);
+                }
+            }
+        }
+        for(int index = 0; index < size; index++)
+        {
+            if(not is_branched[index])
+            {
+                trunk.push_back(index);
+            }
+        }
+    }
+
+    bool is_parallel() const
+    {
+        return workers.size() > 0 and branches.size() > 1;
+    }
+
+    bool is_profiling() const
+    {
+        return profile_mode not_eq profile_mode_t::off;
+    }
+
+    void cycle_profile_mode()
+    {
+        if(profile_mode == profile_mode_t::off)
+        {
+            profile_mode = profile_mode_t::sampled;
+        }
+        else
+        if(profile_mode == profile_mode_t::sampled)
+        {
+            profile_mode = profile_mode_t::full;
+        }
+        else
+        {
+            profile_mode = profile_mode_t::off;
+        }
+    }
+
+    std::string get_profile_mode_name() const
+    {
+        if(profile_mode == profile_mode_t::sampled)
+        {
+            return "sampled 1/" + std::to_string(profile_sample_period);
+        }
+        else
+        if(profile_mode == profile_mode_t::full)
+        {
+            return "full";
+        }
+        return "off";
+    }
+
+    bool is_timed_step()
+    {
+        if(profile_mode == profile_mode_t::sampled)
+        {
+            return profile_tick++ % profile_sample_period == 0;
+        }
+        return profile_mode == profile_mode_t::full;
+    }
+
+    /* a step runs in four phases - every node does its own work, then every edge
+     * computes its flux from the same snapshot of node states, then the fluxes are
+     * balanced against their sources as a whole, then every flux is applied in edge
+     * order. no edge sees another edge's debit, so the step does not depend on visit
+     * order. with workers, trunk nodes run first on the calling thread, then the
+     * branches and the fluxes are spread across the pool. the balance and apply phases
+     * stay serial, so parcels reach join nodes in edge order, and a parallel step is
+     * bit identical to a serial one */
+
+    template <typename handle_node_t, typename handle_flux_t, typename handle_balance_t, typename handle_apply_t>
+    void execute(handle_node_t handle_node, handle_flux_t handle_flux, handle_balance_t handle_balance, handle_apply_t handle_apply)
+    {
+        if(is_timed_step())
+        {
+            /* a sampled step stands in for the steps that were skipped */
+            double scale = profile_mode == profile_mode_t::sampled ? profile_sample_period : 1.0;
+            execute_timed(handle_node, handle_flux, handle_balance, handle_apply, scale);
+            return;
+        }
+        int size = edges.size();
+        if(is_parallel())
+        {
+            for(int index : trunk)
+            {
+                handle_node(nodes[index]);
+            }
+            workers.run(branches.size(),
+                [this, &handle_node](int branch)
+                {
+                    for(int index : branches[branch])
+                    {
+                        handle_node(nodes[index]);
+                    }
+                }
+            );
+            int chunks = workers.size() + 1;
+            workers.run(chunks,
+                [this, &handle_flux, size, chunks](int chunk)
+                {
+                    for(int edge = chunk * size / chunks; edge < (chunk + 1) * size / chunks; edge++)
+                    {
+                        const schedule_edge_t& record = edges[edge];
+                        handle_flux(edge, nodes[record.parent], nodes[record.child], record.port);
+                    }
+                }
+            );
+        }
+        else
+        {
+            for(node_t* node : nodes)
+            {
+                handle_node(node);
+            }
+            for(int edge = 0; edge < size; edge++)
+            {
+                const schedule_edge_t& record = edges[edge];
+                handle_flux(edge, nodes[record.parent], nodes[record.child], record.port);
+            }
+        }
+        handle_balance();
+        for(int edge = 0; edge < size; edge++)
+        {
+            const schedule_edge_t& record = edges[edge];
+            handle_apply(edge, nodes[record.parent], nodes[record.child], record.port);
+        }
+    }
+
+    template <typename handle_node_t, typename handle_flux_t, typename handle_balance_t, typename handle_apply_t>
+    void execute_timed(handle_node_t handle_node, handle_flux_t handle_flux, handle_balance_t handle_balance, handle_apply_t handle_apply, double scale)
+    {
+        for(node_t* node : nodes)
+        {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            handle_node(node);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            node->work_time_ns += scale * std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        }
+        int size = edges.size();
+        for(int edge = 0; edge < size; edge++)
+        {
+            const schedule_edge_t& record = edges[edge];
+            auto t0 = std::chrono::high_resolution_clock::now();
+            handle_flux(edge, nodes[record.parent], nodes[record.child], record.port);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            record.port->work_time_ns += scale * std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        }
+        handle_balance();
+        for(int edge = 0; edge < size; edge++)
+        {
+            const schedule_edge_t& record = edges[edge];
+            auto t0 = std::chrono::high_resolution_clock::now();
+            handle_apply(edge, nodes[record.parent], nodes[record.child], record.port);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            record.port->work_time_ns += scale * std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        }
+    }
+};
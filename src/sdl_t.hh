@@ -32,6 +32,7 @@ struct sdl_t
     std::function<void(void)> edit_on_j_key_down;
     std::function<void(void)> edit_on_k_key_down;
     std::function<void(void)> edit_on_q_key_down;
+    std::function<void(void)> edit_on_t_key_down;
     std::function<void(void)> edit_on_delete_key_down;
     std::function<void(void)> append_on_ctrl_w_key_down;
     std::function<void(void)> append_on_esc_key_down;
@@ -41,10 +42,14 @@ struct sdl_t
     render_rect_t selection_box;
     SDL_AudioSpec spec;
     SDL_AudioDeviceID audio_device;
+    ring_t<float, sim_n::audio_ring_frames * sim_n::cycles_per_frame> audio_ring;
+    std::atomic<int> audio_underruns = 0;
+    bool was_audio_served = false; /* audio thread only */
     bool selection_box_is_valid = false;
     bool is_append_mode = false;
     bool is_pause_mode = false;
     bool is_help_mode = false;
+    bool is_profiling = false;
     int append_line = 0;
     int running_animation_index = 0;
     std::array<std::string, 8> running_animation = {"|", "/", "-", "\\", "|", "/", "-", "\\"};
@@ -65,7 +70,6 @@ struct sdl_t
     };
     moving_average_filter_t frame_time_ms_smoother{128};
     moving_average_filter_t sim_time_ms_smoother{128};
-    pid_controller_t delay_pid{1.0, 0.0, 1.0, 1000.0};
 
     sdl_t(int xres_p, int yres_p)
         : xres_p{xres_p}
@@ -83,7 +87,26 @@ struct sdl_t
             spec.format = AUDIO_F32SYS;
             spec.channels = 1;
             spec.samples = sim_n::cycles_per_frame;
-            spec.callback = nullptr;
+            spec.callback = [](void* userdata, Uint8* stream, int len)
+            {
+                /* runs on the sdl audio thread - drains whatever the simulation thread has
+                 * produced and pads the rest with silence rather than waiting for it */
+                sdl_t* sdl = static_cast<sdl_t*>(userdata);
+                float* samples = reinterpret_cast<float*>(stream);
+                int size = len / sizeof(float);
+                int popped = sdl->audio_ring.pop(samples, size);
+                bool is_served = popped == size;
+                if(is_served == false)
+                {
+                    std::fill(samples + popped, samples + size, 0.0f);
+                    if(sdl->was_audio_served)
+                    {
+                        sdl->audio_underruns++;
+                    }
+                }
+                sdl->was_audio_served = is_served;
+            };
+            spec.userdata = this;
             audio_device = SDL_OpenAudioDevice(nullptr, 0, &spec, nullptr, 0);
             pause_audio();
         }
@@ -112,22 +135,12 @@ struct sdl_t
 
     void queue_audio(const std::vector<float>& buffer)
     {
-        int bytes = buffer.size() * sizeof(float);
-        SDL_QueueAudio(audio_device, buffer.data(), bytes);
-    }
-
-    int get_audio_queue_size()
-    {
-        return SDL_GetQueuedAudioSize(audio_device) / sizeof(float);
+        audio_ring.push(buffer.data(), buffer.size());
     }
 
-    void controller_delay(double cycle_total_ms)
+    int get_audio_queue_size() const
     {
-        double audio_queue_setpoint = 2 * sim_n::cycles_per_frame;
-        double signal_ms = delay_pid.compute(audio_queue_setpoint, get_audio_queue_size());
-        double cycle_max_ms = 1000.0 * sim_n::dt_s * sim_n::cycles_per_frame;
-        double delay_ms = cycle_max_ms - cycle_total_ms - signal_ms;
-        delay(delay_ms);
+        return audio_ring.size();
     }
 
     void delay(int ms)
@@ -473,12 +486,15 @@ struct sdl_t
         std::vector<colo_text_t> texts = {
             {colo_t::white, double_to_string(node->volume->calc_total_pressure_pa(), 0) + " pa"},
             {colo_t::white, node->volume->name},
-            {colo_t::white, double_to_string(node->volume->static_temperature_k, 0) + " k"},
+            {colo_t::white, double_to_string(node->volume->static_temperature_k(), 0) + " k"},
             {colo_t::white, double_to_string(node->children.size(), 0)},
             {colo_t::white, double_to_string(node->volume->gas_mail.size(), 0)},
             {colo_t::white, double_to_string(node->volume->max_gas_mail_size, 0)},
-            {colo_t::white, double_to_string(node->work_time_ns / 1e6, 4) + " ms"},
         };
+        if(is_profiling)
+        {
+            texts.push_back({colo_t::white, double_to_string(node->work_time_ns / 1e6, 4) + " ms"});
+        }
         draw_texts(circle.x_p, circle.y_p, texts, ui_n::node_font_multiplier, true);
     }
 
@@ -521,8 +537,11 @@ struct sdl_t
             {colo_t::white, double_to_string(parent->port->diameter_m, 3) + " m"},
             {colo_t::white, double_to_string(parent->port->length_m, 3) + " m"},
             {colo_t::white, double_to_string(parent->port->open_ratio, 3) + ""},
-            {colo_t::white, double_to_string(parent->port->work_time_ns / 1e6, 4) + " ms"},
         };
+        if(is_profiling)
+        {
+            texts.push_back({colo_t::white, double_to_string(parent->port->work_time_ns / 1e6, 4) + " ms"});
+        }
         draw_texts(xm_p, ym_p, texts, ui_n::node_font_multiplier, true);
     }
 
@@ -531,7 +550,7 @@ struct sdl_t
         std::vector<colo_text_t> texts;
         for(const prop_t& prop : prop_table->table)
         {
-            texts.push_back({colo_t::white, prop.key + " : " + prop.value});
+            texts.push_back({colo_t::white, std::string{prop.key} + " : " + prop.value});
         }
         if(texts.size() > 0)
         {
@@ -769,6 +788,11 @@ struct sdl_t
                 edit_on_q_key_down();
             }
             else
+            if(sym == SDLK_t)
+            {
+                edit_on_t_key_down();
+            }
+            else
             if(sym == SDLK_DELETE)
             {
                 edit_on_delete_key_down();
@@ -816,13 +840,14 @@ struct sdl_t
     {
         frame_time_ms = frame_time_ms_smoother.filter(frame_time_ms);
         sim_time_ms = sim_time_ms_smoother.filter(sim_time_ms);
-        double audio_time_ms = 1000.0 * sim_n::cycles_per_frame / sim_n::sample_frequency_hz;
+        double audio_time_ms = sim_n::frame_time_ms;
         std::string frame_time_ms_string = double_to_string(frame_time_ms, 1, 4);
         std::string sim_time_ms_string = double_to_string(sim_time_ms, 1, 4);
         std::string audio_time_ms_string = double_to_string(audio_time_ms, 1, 4);
         std::string audio_queue_size = double_to_string(get_audio_queue_size(), 0, 4);
+        std::string audio_underruns_string = double_to_string(audio_underruns, 0);
         std::string frame = get_running_animation_frame();
-        std::string text = sim_n::title + " " + frame + " " + frame_time_ms_string + " + " + sim_time_ms_string + " / " + audio_time_ms_string + " : " + audio_queue_size;
+        std::string text = sim_n::title + " " + frame + " " + frame_time_ms_string + " + " + sim_time_ms_string + " / " + audio_time_ms_string + " : " + audio_queue_size + " : " + audio_underruns_string;
         if(is_slowmo_mode)
         {
             text += " slowmo!";
@@ -947,6 +972,7 @@ struct sdl_t
             {colo_t::yellow,"                h : this help screen"}, /* highlighted, so the user knows where they are */
             {colo_t::white, "                k : go to previous property"},
             {colo_t::white, "                q : demo breadth first graph execution"},
+            {colo_t::white, "                t : cycle node work time profiling (off, sampled, full)"},
             {colo_t::white, "         ctwl + w : delete a line"},
             {colo_t::white, "           escape : exit append mode"},
             {colo_t::white, "           return : exit append mode"},
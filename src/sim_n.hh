@@ -6,6 +6,25 @@ namespace sim_n
     const int render_demo_delay_per_edge_ms = 32;
     const double sample_frequency_hz = 44100.0;
     const double dt_s = 1.0 / sample_frequency_hz;
+    const double frame_time_ms = 1000.0 * dt_s * cycles_per_frame;
+    const int audio_ring_frames = 8;
+    const int audio_queue_setpoint_frames = 3;
     const int node_bfs_visited_capacity = 32;
+    const int profile_sample_period = 64;
+    const int mail_wheel_horizon_cycles = 512;
+    const int parallel_branch_threshold = 4;
+    const double steady_state_tolerance = 0.05;
+    const int steady_state_window_cycles = 4;
+    const double warm_start_throttle_step = 0.1;
+    const double warm_start_angular_velocity_step_r_per_s = 100.0;
+    const double warm_start_max_distance = 2.0;
+    const int reduced_detail_decimation = 2;
+    const double minimal_detail_torque_smoothing = 0.25;
+    const int audio_wavetable_size = 1024;
+    const int audio_crossfade_samples = 2048;
+    const int checkpoint_version = 2;
+    const int engine_file_version = 2;
     const double four_stroke_r = 4.0 * M_PI;
+    const int max_expression_depth = 32;
+    const double max_flux_draw_ratio = 0.99; /* of a source's moles, across all its out edges in one step */
 }
@@ -0,0 +1,103 @@
+/* watches an engine one four stroke cycle at a time, on the same finished_rotation
+ * boundary the plot panel flips on. each cycle is boiled down to a summary. single
+ * cycles scatter too much from combustion to combustion to ever agree, so the engine
+ * is settled once the mean of the last window of cycles agrees with the mean of the
+ * window before it to within a relative tolerance */
+
+struct cycle_summary_t
+{
+    double peak_pressure_pa = 0.0;
+    double mean_torque_n_m = 0.0;
+    double peak_mol_balance = 0.0;
+    double mean_angular_velocity_r_per_s = 0.0;
+};
+
+struct steady_state_detector_t
+{
+    double tolerance = sim_n::steady_state_tolerance;
+    int window_cycles = sim_n::steady_state_window_cycles;
+    int cycles = 0;
+    int converged_cycle = 0; /* zero until converged */
+    std::deque<cycle_summary_t> history; /* the last two windows, oldest first */
+    cycle_summary_t summary;
+    int samples = 0;
+
+    /* one call per step, after the step - true when the step closed a cycle */
+
+    bool sample(engine_t& engine)
+    {
+        if(engine.crankshaft.finished_rotation())
+        {
+            close_cycle();
+            return true;
+        }
+        for(piston_t* piston : engine.pistons)
+        {
+            summary.peak_pressure_pa = std::max(summary.peak_pressure_pa, piston->calc_static_pressure_pa());
+            summary.peak_mol_balance = std::max(summary.peak_mol_balance, piston->mol_balance);
+        }
+        summary.mean_torque_n_m += engine.calc_applied_torque_n_m();
+        summary.mean_angular_velocity_r_per_s += engine.crankshaft.angular_velocity_r_per_s;
+        samples++;
+        return false;
+    }
+
+    void close_cycle()
+    {
+        if(samples > 0)
+        {
+            summary.mean_torque_n_m /= samples;
+            summary.mean_angular_velocity_r_per_s /= samples;
+        }
+        cycles++;
+        history.push_back(summary);
+        if(static_cast<int>(history.size()) > 2 * window_cycles)
+        {
+            history.pop_front();
+        }
+        if(converged_cycle == 0 and static_cast<int>(history.size()) == 2 * window_cycles)
+        {
+            cycle_summary_t before = calc_mean(0);
+            cycle_summary_t after = calc_mean(window_cycles);
+            if(is_close(before, after))
+            {
+                converged_cycle = cycles;
+            }
+        }
+        summary = {};
+        samples = 0;
+    }
+
+    cycle_summary_t calc_mean(int first) const
+    {
+        cycle_summary_t mean;
+        for(int index = first; index < first + window_cycles; index++)
+        {
+            const cycle_summary_t& other = history[index];
+            mean.peak_pressure_pa += other.peak_pressure_pa / window_cycles;
+            mean.mean_torque_n_m += other.mean_torque_n_m / window_cycles;
+            mean.peak_mol_balance += other.peak_mol_balance / window_cycles;
+            mean.mean_angular_velocity_r_per_s += other.mean_angular_velocity_r_per_s / window_cycles;
+        }
+        return mean;
+    }
+
+    bool is_close(double a, double b) const
+    {
+        double scale = std::max(std::abs(a), std::abs(b));
+        return std::abs(a - b) <= tolerance * scale;
+    }
+
+    bool is_close(const cycle_summary_t& a, const cycle_summary_t& b) const
+    {
+        return is_close(a.peak_pressure_pa, b.peak_pressure_pa)
+           and is_close(a.mean_torque_n_m, b.mean_torque_n_m)
+           and is_close(a.peak_mol_balance, b.peak_mol_balance)
+           and is_close(a.mean_angular_velocity_r_per_s, b.mean_angular_velocity_r_per_s);
+    }
+
+    bool is_converged() const
+    {
+        return converged_cycle > 0;
+    }
+};
@@ -13,4 +13,11 @@ namespace thermofluidics_n
     const double gamma_combusted = 1.3; /* fuel */
     const double gamma_air = 1.4;
     const double r_j_per_mol_k = 8.314;
+
+    double calc_gamma(double air_molar_ratio, double fuel_molar_ratio, double combusted_molar_ratio)
+    {
+        return gamma_combusted * combusted_molar_ratio
+             + gamma_air * air_molar_ratio
+             + gamma_fuel * fuel_molar_ratio;
+    }
 }
@@ -27,9 +27,29 @@ namespace util_n
 
     std::string double_to_string(double value, int precision, int width = 0)
     {
-        std::ostringstream stream;
-        stream << std::fixed << std::setw(width) << std::setprecision(precision) << value;
-        return stream.str();
+        std::array<char, 512> chars;
+        std::to_chars_result result = std::to_chars(chars.data(), chars.data() + chars.size(), value, std::chars_format::fixed, precision);
+        if(result.ec not_eq std::errc{})
+        {
+            std::ostringstream stream; /* only the very largest doubles at high precision */
+            stream << std::fixed << std::setw(width) << std::setprecision(precision) << value;
+            return stream.str();
+        }
+        std::string text(chars.data(), result.ptr);
+        int size = text.size();
+        if(size < width)
+        {
+            text.insert(0, width - size, ' ');
+        }
+        return text;
+    }
+
+    /* the shortest text that reads back as the same double */
+    std::string double_to_exact_string(double value)
+    {
+        std::array<char, 32> chars;
+        std::to_chars_result result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+        return std::string(chars.data(), result.ptr);
     }
 
     double interpolate(double input, double lower_bound, double lower_value, double upper_bound, double upper_value)
@@ -1,3 +1,27 @@
+/* everything a volume carries from one step to the next, less its mail. fields only
+ * some volumes have (flames, controllers, rev limiting) sit unused in the others */
+
+struct volume_state_t
+{
+    double static_temperature_k = 0.0;
+    double bulk_momentum_kg_m_per_s = 0.0;
+    double moles = 0.0;
+    double air_molar_ratio = 0.0;
+    double fuel_molar_ratio = 0.0;
+    double combusted_molar_ratio = 0.0;
+    double mol_balance = 0.0;
+    double diameter_m = 0.0;
+    double depth_m = 0.0;
+    flame_t flame;
+    double rigged_theta_r = 0.0;
+    double controller_previous_error = 0.0;
+    double controller_integral = 0.0;
+    bool is_enabled = true;
+    bool is_rev_limiter_enabled = false;
+};
+
+static_assert(std::is_trivially_copyable_v<volume_state_t>);
+
 struct volume_t
 : flowing_gas_t
 , observable_t
@@ -5,25 +29,25 @@ struct volume_t
     std::string name = "";
     double diameter_m = 0.0;
     double depth_m = 0.0;
-    std::priority_queue<gas_parcel_t, std::vector<gas_parcel_t>, std::greater<>> gas_mail;
+    mail_wheel_t<gas_parcel_t> gas_mail;
     int max_gas_mail_size = 0;
-    port_t* port = nullptr;
 
-    volume_t(const std::string& name, double diameter_m, double depth_m)
-        : name{name}
+    volume_t(gas_store_t& gas_store, const std::string& name, double diameter_m, double depth_m)
+        : flowing_gas_t{gas_store}
+        , name{name}
         , diameter_m{diameter_m}
         , depth_m{depth_m}
         {
             normalize();
         }
 
-    volume_t(const std::string& name)
-        : volume_t{name, 0.05, 0.1}
+    volume_t(gas_store_t& gas_store, const std::string& name)
+        : volume_t{gas_store, name, 0.05, 0.1}
         {
         }
 
-    volume_t()
-        : volume_t{"volume"}
+    volume_t(gas_store_t& gas_store)
+        : volume_t{gas_store, "volume"}
         {
         }
 
@@ -54,7 +78,7 @@ struct volume_t
 
     double calc_actual_volume_m3() const
     {
-        return mol_balance * thermofluidics_n::r_j_per_mol_k * static_temperature_k / calc_static_pressure_pa();
+        return mol_balance * thermofluidics_n::r_j_per_mol_k * static_temperature_k() / calc_static_pressure_pa();
     }
 
     double calc_volumetric_efficiency() const
@@ -62,16 +86,6 @@ struct volume_t
         return calc_actual_volume_m3() / calc_displacement_volume_m3();
     }
 
-    double calc_flow_area_m2() const override
-    {
-        return port->calc_flow_area_m2();
-    }
-
-    double calc_flow_length_m() const override
-    {
-        return port->length_m;
-    }
-
     void receive_mail(const gas_parcel_t& parcel)
     {
         gas_mail.push(parcel);
@@ -81,38 +95,66 @@ struct volume_t
 
     void read_mail(int cycle)
     {
-        while(not gas_mail.empty())
-        {
-            const gas_parcel_t& mail = gas_mail.top();
-            if(mail.arrival_cycle > cycle)
+        gas_mail.drain(cycle,
+            [this](const gas_parcel_t& mail)
             {
-                break;
+                mix_in(mail);
             }
-            mix_in(mail);
-            gas_mail.pop();
-        }
+        );
     }
 
     virtual void tag_mail(gas_parcel_t&, const volume_t&)
     {
     }
 
-    void send_mail(volume_t& destination, int cycle)
+    /* flux phase - reads both volumes and writes nothing, so every edge of a step sees the same snapshot */
+
+    std::optional<gas_parcel_t> calc_mail(const volume_t& destination, const port_t& port, int cycle, double dt_s) const
     {
-        if(calc_flow_area_m2() > 0.0)
+        if(port.calc_flow_area_m2() > 0.0)
         {
             double mach_number = calc_mach_number(destination);
-            gas_parcel_t parcel = package_gas_parcel(mach_number, cycle);
-            add_moles_adiabatically(-parcel.moles);
-            add_momentum(-parcel.bulk_momentum_kg_m_per_s);
-            tag_mail(parcel, destination);
-            destination.receive_mail(parcel);
-            port->flow_velocity_m_per_s.set(parcel.velocity_m_per_s);
-        }
-        else
-        {
-            port->flow_velocity_m_per_s.set(0.0);
+            return package_gas_parcel(port, mach_number, cycle, dt_s);
         }
+        return std::nullopt;
+    }
+
+    /* apply phase - debits the sender and posts the parcel */
+
+    void send_mail(volume_t& destination, port_t& port, gas_parcel_t parcel)
+    {
+        add_moles_adiabatically(-parcel.moles);
+        add_momentum(-parcel.bulk_momentum_kg_m_per_s);
+        tag_mail(parcel, destination);
+        destination.receive_mail(parcel);
+        port.flow_velocity_m_per_s.set(parcel.velocity_m_per_s);
+    }
+
+    virtual void capture_state(volume_state_t& state) const
+    {
+        state.static_temperature_k = static_temperature_k();
+        state.bulk_momentum_kg_m_per_s = bulk_momentum_kg_m_per_s();
+        state.moles = moles();
+        state.air_molar_ratio = air_molar_ratio();
+        state.fuel_molar_ratio = fuel_molar_ratio();
+        state.combusted_molar_ratio = combusted_molar_ratio();
+        state.mol_balance = mol_balance;
+        state.diameter_m = diameter_m;
+        state.depth_m = depth_m;
+    }
+
+    virtual void restore_state(const volume_state_t& state)
+    {
+        static_temperature_k() = state.static_temperature_k;
+        bulk_momentum_kg_m_per_s() = state.bulk_momentum_kg_m_per_s;
+        moles() = state.moles;
+        air_molar_ratio() = state.air_molar_ratio;
+        fuel_molar_ratio() = state.fuel_molar_ratio;
+        combusted_molar_ratio() = state.combusted_molar_ratio;
+        mol_balance = state.mol_balance;
+        diameter_m = state.diameter_m;
+        depth_m = state.depth_m;
+        invalidate_composition();
     }
 
     virtual std::vector<double> get_plot_datum()
@@ -122,7 +164,7 @@ struct volume_t
         datum[panel_volume] = calc_volume_m3();
         datum[panel_volumetric_efficiency] = calc_volumetric_efficiency();
         datum[panel_total_pressure] = calc_total_pressure_pa();
-        datum[panel_static_temperature] = static_temperature_k;
+        datum[panel_static_temperature] = static_temperature_k();
         datum[panel_gamma] = calc_gamma();
         datum[panel_molar_mass] = calc_molar_mass_kg_per_mol();
         datum[panel_air_fuel_mass_ratio] = calc_air_fuel_mass_ratio();
@@ -137,16 +179,23 @@ struct volume_t
     {
     }
 
-    virtual void ignite()
+    virtual void ignite(double)
+    {
+    }
+
+    /* false when node work writes anything outside this volume */
+
+    virtual bool is_parallel_safe() const
     {
+        return true;
     }
 };
 
 struct source_t
 : volume_t
 {
-    source_t()
-        : volume_t{"source", 1000.0, 1000.0}
+    source_t(gas_store_t& gas_store)
+        : volume_t{gas_store, "source", 1000.0, 1000.0}
         {
         }
 };
@@ -154,8 +203,8 @@ struct source_t
 struct plenum_t
 : volume_t
 {
-    plenum_t()
-        : volume_t{"plenum", 0.1, 0.1}
+    plenum_t(gas_store_t& gas_store)
+        : volume_t{gas_store, "plenum", 0.1, 0.1}
         {
         }
 };
@@ -168,8 +217,8 @@ struct injector_t
     pid_controller_t pid_controller{0.1, 0.0, 0.1, 1e6};
     double air_fuel_mass_ratio_setpoint = 14.7;
 
-    injector_t(throttle_cable_t& throttle_cable)
-        : volume_t{"injector", 0.12, 0.12}
+    injector_t(gas_store_t& gas_store, throttle_cable_t& throttle_cable)
+        : volume_t{gas_store, "injector", 0.12, 0.12}
         , throttle_cable{throttle_cable}
         {
         }
@@ -196,6 +245,22 @@ struct injector_t
         delete_from(observers, this);
     }
 
+    void capture_state(volume_state_t& state) const override
+    {
+        volume_t::capture_state(state);
+        state.controller_previous_error = pid_controller.previous_error;
+        state.controller_integral = pid_controller.integral;
+        state.is_enabled = is_enabled;
+    }
+
+    void restore_state(const volume_state_t& state) override
+    {
+        volume_t::restore_state(state);
+        pid_controller.previous_error = state.controller_previous_error;
+        pid_controller.integral = state.controller_integral;
+        is_enabled = state.is_enabled;
+    }
+
     void tag_mail(gas_parcel_t& parcel, const volume_t& to) override
     {
         if(is_enabled)
@@ -214,6 +279,49 @@ struct injector_t
     }
 };
 
+/* what turns a piston's gas pressure and crank angle into torque on the crank - a piston makes
+ * one from its props for its own plots, and the drivetrain keeps one per piston */
+
+struct cylinder_t
+{
+    double moment_of_inertia_kg_per_m2 = 0.0;
+    double head_area_m2 = 0.0;
+    double crankshaft_offset_theta_r = 0.0;
+    double crank_throw_length_m = 0.0;
+    double connecting_rod_length_m = 0.0;
+    double friction_coefficient = 0.0;
+
+    double calc_gas_torque_n_m(double static_gauge_pressure_pa, double theta_r, double sin_theta_r) const
+    {
+        double term1 = static_gauge_pressure_pa * head_area_m2 * crank_throw_length_m * sin_theta_r;
+        double term2 = 1.0 + (crank_throw_length_m / connecting_rod_length_m) * std::cos(theta_r);
+        double gas_torque_n_m = term1 * term2;
+        return gas_torque_n_m;
+    }
+
+    double calc_inertia_torque_n_m(double angular_velocity_r_per_s, double theta_r, double sin_theta_r) const
+    {
+        double term1 = 0.25 * sin_theta_r * crank_throw_length_m / connecting_rod_length_m;
+        double term2 = 0.50 * std::sin(2.0 * theta_r);
+        double term3 = 0.75 * std::sin(3.0 * theta_r) * crank_throw_length_m / connecting_rod_length_m;
+        return moment_of_inertia_kg_per_m2 * std::pow(angular_velocity_r_per_s, 2.0) * (term1 - term2 - term3);
+    }
+
+    /* both torques share the sine of the piston's crank angle */
+
+    double calc_applied_torque_n_m(double static_gauge_pressure_pa, double crankshaft_theta_r, double angular_velocity_r_per_s) const
+    {
+        double theta_r = crankshaft_theta_r - crankshaft_offset_theta_r;
+        double sin_theta_r = std::sin(theta_r);
+        return calc_gas_torque_n_m(static_gauge_pressure_pa, theta_r, sin_theta_r) + calc_inertia_torque_n_m(angular_velocity_r_per_s, theta_r, sin_theta_r);
+    }
+
+    double calc_friction_torque_n_m(double angular_velocity_r_per_s) const
+    {
+        return angular_velocity_r_per_s * friction_coefficient;
+    }
+};
+
 /* ------- + block_deck_surface_m
  *         | head_clearance_height_m
  * ------- +
@@ -253,9 +361,10 @@ struct piston_t
     camshaft_t& camshaft;
     sparkplug_t sparkplug{camshaft};
     flame_t flame;
+    double rigged_theta_r = 0.0; /* the crank turns between passes at reduced detail, so this can lag it */
 
-    piston_t(camshaft_t& camshaft)
-        : volume_t{"piston"}
+    piston_t(gas_store_t& gas_store, camshaft_t& camshaft)
+        : volume_t{gas_store, "piston"}
         , camshaft{camshaft}
         {
             rig();
@@ -288,16 +397,6 @@ struct piston_t
         delete_from(observers, this);
     }
 
-    void on_create(std::vector<rotational_mass_t*>& observers) override
-    {
-        subscribe_to(observers, static_cast<rotational_mass_t*>(this));
-    }
-
-    void on_delete(std::vector<rotational_mass_t*>& observers) override
-    {
-        delete_from(observers, static_cast<rotational_mass_t*>(this));
-    }
-
     double calc_theta_r() const
     {
         return camshaft.crankshaft.theta_r - crankshaft_offset_theta_r;
@@ -338,25 +437,39 @@ struct piston_t
         return calc_cylinder_volume_m3(diameter_m, calc_chamber_depth_m(connecting_rod_length_m - crank_throw_length_m));
     }
 
-    double calc_gas_torque_n_m() const
+    cylinder_t calc_cylinder() const
     {
-        double term1 = calc_static_gauge_pressure_pa() * calc_circle_area_m2(diameter_m) * crank_throw_length_m * std::sin(calc_theta_r());
-        double term2 = 1.0 + (crank_throw_length_m / connecting_rod_length_m) * std::cos(calc_theta_r());
-        double gas_torque_n_m = term1 * term2;
-        return gas_torque_n_m;
+        cylinder_t cylinder = {
+            calc_moment_of_inertia_kg_per_m2(),
+            calc_circle_area_m2(diameter_m),
+            crankshaft_offset_theta_r,
+            crank_throw_length_m,
+            connecting_rod_length_m,
+            friction_coefficient,
+        };
+        return cylinder;
     }
 
-    double calc_inertia_torque_n_m() const
+    /* the props a cylinder is made from */
+
+    bool is_cylinder_input(const double* real) const
     {
-        double term1 = 0.25 * std::sin(1.0 * calc_theta_r()) * crank_throw_length_m / connecting_rod_length_m;
-        double term2 = 0.50 * std::sin(2.0 * calc_theta_r());
-        double term3 = 0.75 * std::sin(3.0 * calc_theta_r()) * crank_throw_length_m / connecting_rod_length_m;
-        return calc_moment_of_inertia_kg_per_m2() * std::pow(camshaft.crankshaft.angular_velocity_r_per_s, 2.0) * (term1 - term2 - term3);
+        std::initializer_list<const double*> inputs = {
+            &diameter_m,
+            &crankshaft_offset_theta_r,
+            &crank_throw_length_m,
+            &connecting_rod_length_m,
+            &connecting_rod_mass_kg,
+            &head_mass_density_kg_per_m3,
+            &head_compression_height_m,
+            &friction_coefficient,
+        };
+        return std::find(inputs.begin(), inputs.end(), real) not_eq inputs.end();
     }
 
     double calc_applied_torque_n_m() const override
     {
-        return calc_gas_torque_n_m() + calc_inertia_torque_n_m();
+        return calc_cylinder().calc_applied_torque_n_m(calc_static_gauge_pressure_pa(), camshaft.crankshaft.theta_r, camshaft.crankshaft.angular_velocity_r_per_s);
     }
 
     double calc_head_mass_kg() const
@@ -372,7 +485,7 @@ struct piston_t
 
     double calc_friction_torque_n_m() const override
     {
-        return camshaft.crankshaft.angular_velocity_r_per_s * friction_coefficient;
+        return calc_cylinder().calc_friction_torque_n_m(camshaft.crankshaft.angular_velocity_r_per_s);
     }
 
     void update_bearing_position(double theta_r)
@@ -389,14 +502,20 @@ struct piston_t
         pin_y_m = term1 + term2;
     }
 
-    void rig()
+    void rig(double theta_r)
     {
-        update_bearing_position(calc_theta_r());
-        update_pin_position(calc_theta_r());
+        rigged_theta_r = theta_r;
+        update_bearing_position(theta_r);
+        update_pin_position(theta_r);
         depth_m = calc_chamber_depth_m();
         head_mass_kg = calc_head_mass_kg();
     }
 
+    void rig()
+    {
+        rig(calc_theta_r());
+    }
+
     void compress() override
     {
         double old_volume_m3 = calc_volume_m3();
@@ -413,7 +532,23 @@ struct piston_t
         return datum;
     }
 
-    void ignite() override
+    void capture_state(volume_state_t& state) const override
+    {
+        volume_t::capture_state(state);
+        state.flame = flame;
+        state.rigged_theta_r = rigged_theta_r;
+        state.is_enabled = sparkplug.is_enabled;
+    }
+
+    void restore_state(const volume_state_t& state) override
+    {
+        volume_t::restore_state(state);
+        flame = state.flame;
+        sparkplug.is_enabled = state.is_enabled;
+        rig(state.rigged_theta_r);
+    }
+
+    void ignite(double dt_s) override
     {
         double ignition_ratio = sparkplug.calc_ignition_ratio();
         if(ignition_ratio > 0.95)
@@ -422,7 +557,7 @@ struct piston_t
         }
         if(flame.is_burning)
         {
-            flame.grow(*this, diameter_m, depth_m, 1.0); /* from top - grows only down */
+            flame.grow(*this, diameter_m, depth_m, 1.0, dt_s); /* from top - grows only down */
             burn_fuel_by_volume(flame.calc_volume_m3());
         }
     }
@@ -438,8 +573,8 @@ struct throttle_t
     double rev_limit_hysteresis_r_per_s = 50.0;
     bool is_rev_limiter_enabled = false;
 
-    throttle_t(std::vector<piston_t*>& pistons, std::vector<injector_t*>& injectors, crankshaft_t& crankshaft)
-        : volume_t{"throttle", 0.1, 0.1}
+    throttle_t(gas_store_t& gas_store, std::vector<piston_t*>& pistons, std::vector<injector_t*>& injectors, crankshaft_t& crankshaft)
+        : volume_t{gas_store, "throttle", 0.1, 0.1}
         , pistons{pistons}
         , injectors{injectors}
         , crankshaft{crankshaft}
@@ -481,6 +616,23 @@ struct throttle_t
         }
     }
 
+    bool is_parallel_safe() const override
+    {
+        return false; /* the rev limiter toggles pistons and injectors */
+    }
+
+    void capture_state(volume_state_t& state) const override
+    {
+        volume_t::capture_state(state);
+        state.is_rev_limiter_enabled = is_rev_limiter_enabled;
+    }
+
+    void restore_state(const volume_state_t& state) override
+    {
+        volume_t::restore_state(state);
+        is_rev_limiter_enabled = state.is_rev_limiter_enabled;
+    }
+
     void do_work() override
     {
         if(crankshaft.angular_velocity_r_per_s > rev_limit_r_per_s)
@@ -505,8 +657,8 @@ struct collector_t
     audio_processor_t& audio_processor;
     crankshaft_t& crankshaft;
 
-    collector_t(audio_processor_t& audio_processor, crankshaft_t& crankshaft)
-        : volume_t{"collector", 0.1, 0.2}
+    collector_t(gas_store_t& gas_store, audio_processor_t& audio_processor, crankshaft_t& crankshaft)
+        : volume_t{gas_store, "collector", 0.1, 0.2}
         , audio_processor{audio_processor}
         , crankshaft{crankshaft}
         {
@@ -517,6 +669,11 @@ struct collector_t
         return volume_t::get_prop_table() + audio_processor.get_prop_table();
     }
 
+    bool is_parallel_safe() const override
+    {
+        return false; /* all collectors share one audio processor */
+    }
+
     void do_work() override
     {
         if(crankshaft.turned())
@@ -537,8 +694,8 @@ struct collector_t
 struct exhaust_t
 : volume_t
 {
-    exhaust_t()
-        : volume_t{"exhaust", 0.1, 0.1}
+    exhaust_t(gas_store_t& gas_store)
+        : volume_t{gas_store, "exhaust", 0.1, 0.1}
         {
         }
 };
@@ -546,8 +703,8 @@ struct exhaust_t
 struct sink_t
 : volume_t
 {
-    sink_t()
-        : volume_t{"sink", 1000.0, 1000.0}
+    sink_t(gas_store_t& gas_store)
+        : volume_t{gas_store, "sink", 1000.0, 1000.0}
         {
         }
 };
@@ -0,0 +1,80 @@
+/* converged engine states, keyed by the engine they came from and the throttle and
+ * crank speed they settled at. a fresh run looks up the nearest cached operating point
+ * of the same engine and starts from there rather than from still air and a stopped
+ * crank. distances are counted in throttle and speed steps, and anything further than
+ * the max distance away is a cold start. safe to share between threads */
+
+struct operating_point_t
+{
+    double throttle = 0.0;
+    double angular_velocity_r_per_s = 0.0;
+
+    double calc_distance(const operating_point_t& other) const
+    {
+        double throttle_steps = (throttle - other.throttle) / sim_n::warm_start_throttle_step;
+        double angular_velocity_steps = (angular_velocity_r_per_s - other.angular_velocity_r_per_s) / sim_n::warm_start_angular_velocity_step_r_per_s;
+        return std::hypot(throttle_steps, angular_velocity_steps);
+    }
+};
+
+struct warm_start_t
+{
+    operating_point_t operating_point;
+    std::shared_ptr<const engine_state_t> state;
+};
+
+struct warm_start_cache_t
+{
+    double max_distance = sim_n::warm_start_max_distance;
+    std::unordered_map<size_t, std::vector<warm_start_t>> warm_starts;
+    mutable std::mutex mutex;
+
+    void store(size_t engine_hash, const operating_point_t& operating_point, engine_state_t&& state)
+    {
+        std::shared_ptr<const engine_state_t> shared_state = std::make_shared<const engine_state_t>(std::move(state));
+        std::lock_guard<std::mutex> lock{mutex};
+        std::vector<warm_start_t>& engine_warm_starts = warm_starts[engine_hash];
+        for(warm_start_t& warm_start : engine_warm_starts)
+        {
+            if(warm_start.operating_point.calc_distance(operating_point) == 0.0)
+            {
+                warm_start.state = shared_state;
+                return;
+            }
+        }
+        engine_warm_starts.push_back({operating_point, shared_state});
+    }
+
+    std::shared_ptr<const engine_state_t> find(size_t engine_hash, const operating_point_t& operating_point) const
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        std::unordered_map<size_t, std::vector<warm_start_t>>::const_iterator iterator = warm_starts.find(engine_hash);
+        if(iterator == warm_starts.end())
+        {
+            return nullptr;
+        }
+        std::shared_ptr<const engine_state_t> nearest_state = nullptr;
+        double nearest_distance = max_distance;
+        for(const warm_start_t& warm_start : iterator->second)
+        {
+            double distance = warm_start.operating_point.calc_distance(operating_point);
+            if(distance <= nearest_distance)
+            {
+                nearest_state = warm_start.state;
+                nearest_distance = distance;
+            }
+        }
+        return nearest_state;
+    }
+
+    int size() const
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        int count = 0;
+        for(const auto& [engine_hash, engine_warm_starts] : warm_starts)
+        {
+            count += engine_warm_starts.size();
+        }
+        return count;
+    }
+};
@@ -0,0 +1,177 @@
+/* a fixed set of threads that run one batch of tasks per call to run(). the
+ * calling thread works too, and task i always goes to the same thread, so no
+ * tasks are claimed through shared counters and every worker takes part in
+ * every batch. a batch per simulation step is far too often to sleep on a
+ * condition variable, so both sides spin briefly before blocking */
+
+struct worker_slot_t
+{
+    alignas(64) std::atomic<int> finished_batch = 0;
+    std::exception_ptr error;
+};
+
+struct worker_pool_t
+{
+    static const int spin_count = 4096;
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<worker_slot_t>> slots;
+    std::atomic<int> batch = 0;
+    std::atomic<bool> is_done = false;
+    int task_count = 0;
+    void (*invoke)(const void*, int) = nullptr;
+    const void* context = nullptr;
+
+    worker_pool_t() = default;
+    worker_pool_t(const worker_pool_t&) = delete;
+    worker_pool_t& operator=(const worker_pool_t&) = delete;
+
+    ~worker_pool_t()
+    {
+        stop();
+    }
+
+    int size() const
+    {
+        return threads.size();
+    }
+
+    void resize(int thread_count)
+    {
+        if(thread_count == size())
+        {
+            return;
+        }
+        stop();
+        for(int index = 0; index < thread_count; index++)
+        {
+            slots.push_back(std::make_unique<worker_slot_t>());
+            slots.back()->finished_batch = batch.load();
+        }
+        for(int index = 0; index < thread_count; index++)
+        {
+            threads.emplace_back(
+                [this, index]()
+                {
+                    work(index);
+                }
+            );
+        }
+    }
+
+    void stop()
+    {
+        if(threads.empty())
+        {
+            return;
+        }
+        is_done = true;
+        batch++;
+        batch.notify_all();
+        for(std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        threads.clear();
+        slots.clear();
+        is_done = false;
+    }
+
+    template <typename atomic_t>
+    static void spin_wait_while_equal(const atomic_t& value, int old_value)
+    {
+        for(int spin = 0; spin < spin_count; spin++)
+        {
+            if(value.load(std::memory_order_acquire) not_eq old_value)
+            {
+                return;
+            }
+        }
+        value.wait(old_value, std::memory_order_acquire);
+    }
+
+    void take_tasks(int worker)
+    {
+        int stride = size() + 1;
+        for(int task = worker; task < task_count; task += stride)
+        {
+            invoke(context, task);
+        }
+    }
+
+    void work(int index)
+    {
+        worker_slot_t& slot = *slots[index];
+        int seen_batch = slot.finished_batch;
+        while(true)
+        {
+            spin_wait_while_equal(batch, seen_batch);
+            seen_batch = batch.load(std::memory_order_acquire);
+            if(is_done)
+            {
+                return;
+            }
+            try
+            {
+                take_tasks(index + 1);
+            }
+            catch(...)
+            {
+                slot.error = std::current_exception();
+            }
+            slot.finished_batch.store(seen_batch, std::memory_order_release);
+            slot.finished_batch.notify_one();
+        }
+    }
+
+    /* runs handle_task(0) .. handle_task(count - 1) and returns once all are done -
+     * the first exception thrown by any task is rethrown here */
+
+    template <typename handle_task_t>
+    void run(int count, const handle_task_t& handle_task)
+    {
+        if(threads.empty())
+        {
+            for(int task = 0; task < count; task++)
+            {
+                handle_task(task);
+            }
+            return;
+        }
+        task_count = count;
+        context = &handle_task;
+        invoke = [](const void* context, int task)
+        {
+            (*static_cast<const handle_task_t*>(context))(task);
+        };
+        int next_batch = batch.load() + 1;
+        batch.store(next_batch, std::memory_order_release);
+        batch.notify_all();
+        std::exception_ptr error;
+        try
+        {
+            take_tasks(0);
+        }
+        catch(...)
+        {
+            error = std::current_exception();
+        }
+        for(std::unique_ptr<worker_slot_t>& slot : slots)
+        {
+            int finished_batch = slot->finished_batch.load(std::memory_order_acquire);
+            while(finished_batch not_eq next_batch)
+            {
+                spin_wait_while_equal(slot->finished_batch, finished_batch);
+                finished_batch = slot->finished_batch.load(std::memory_order_acquire);
+            }
+            if(slot->error and not error)
+            {
+                error = slot->error;
+            }
+            slot->error = nullptr;
+        }
+        if(error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+};